@@ -0,0 +1,139 @@
+//-----------------------------------------------------------------------//
+// ASYNCQUERY.CPP                                                        //
+//                                                                       //
+// AsyncQueries runs GraphM and GraphL searches on a WorkerPool and      //
+// hands back a future for each one, so the caller does not have to wait //
+//-----------------------------------------------------------------------//
+// Ticket: every search returns a QueryTicket.  ticket.result is the     //
+//        future of the QueryResult, ticket.control->cancel() asks the   //
+//        search to stop.  A search given a timeout stops by itself once //
+//        that many milliseconds have passed since it was submitted.     //
+//        Either way the result still arrives, with what was found so    //
+//        far and a status saying why it stopped.                        //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- the graph must not be destroyed or changed until the result is  //
+//       ready, findShortestPath is the only search that changes it      //
+//    -- searches use the workspace of the worker thread they run on     //
+//    -- tasks on the pool never wait on a ticket of the same pool       //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#include "asyncquery.h"
+
+//--------------------------- Constructor ---------------------------------
+// Constructor for class AsyncQueries, runs searches on the given pool
+// Preconditions:   the pool outlives this object and every search
+// Postconditions:  none
+AsyncQueries::AsyncQueries(WorkerPool& workers) : pool(workers) {
+}
+
+//------------------------------ findPath ---------------------------------
+// Submits GraphM::findPath from the first node to the second. The last
+// int is the timeout in milliseconds, 0 or less for none
+// Preconditions:   none
+// Postconditions:  dist and nodes hold the distance and path
+QueryTicket AsyncQueries::findPath(const GraphM& graph, int fromNode,
+                                   int toNode, int timeout) {
+   const GraphM* g = &graph;
+   return submit([g, fromNode, toNode](QueryControl& control,
+                                       QueryResult& result) {
+      result.dist = g->findPath(fromNode, toNode, result.nodes,
+                                QueryWorkspace::local(), control);
+   }, timeout);
+}
+
+//--------------------------- findWithinRadius ----------------------------
+// Submits GraphM::findWithinRadius from the source with the radius. The
+// last int is the timeout in milliseconds, 0 or less for none
+// Preconditions:   none
+// Postconditions:  nodes and dists hold the nodes found, nearest first
+QueryTicket AsyncQueries::findWithinRadius(const GraphM& graph, int source,
+                                           int radius, int timeout) {
+   const GraphM* g = &graph;
+   return submit([g, source, radius](QueryControl& control,
+                                     QueryResult& result) {
+      g->findWithinRadius(source, radius, result.nodes, result.dists,
+                          QueryWorkspace::local(), control);
+   }, timeout);
+}
+
+//----------------------------- findNearest -------------------------------
+// Submits GraphM::findNearest from the source for k nodes. The last int
+// is the timeout in milliseconds, 0 or less for none
+// Preconditions:   none
+// Postconditions:  nodes and dists hold the nodes found, nearest first
+QueryTicket AsyncQueries::findNearest(const GraphM& graph, int source,
+                                      int k, int timeout) {
+   const GraphM* g = &graph;
+   return submit([g, source, k](QueryControl& control, QueryResult& result) {
+      g->findNearest(source, k, result.nodes, result.dists,
+                     QueryWorkspace::local(), control);
+   }, timeout);
+}
+
+//-------------------------- findShortestPath -----------------------------
+// Submits GraphM::findShortestPath, which fills the graph's table. The
+// int is the timeout in milliseconds, 0 or less for none
+// Preconditions:   nothing else uses the graph until the result is ready
+// Postconditions:  if stopped part way through, the table is empty.
+//          if stopped before it started, the table is not changed
+QueryTicket AsyncQueries::findShortestPath(GraphM& graph, int timeout) {
+   GraphM* g = &graph;
+   return submit([g](QueryControl& control, QueryResult&) {
+      g->findShortestPath(control);
+   }, timeout);
+}
+
+//--------------------------- depthFirstOrder -----------------------------
+// Submits GraphL::depthFirstOrder. The int is the timeout in
+// milliseconds, 0 or less for none
+// Preconditions:   none
+// Postconditions:  nodes holds the nodes in depth first order
+QueryTicket AsyncQueries::depthFirstOrder(const GraphL& graph, int timeout) {
+   const GraphL* g = &graph;
+   return submit([g](QueryControl& control, QueryResult& result) {
+      g->depthFirstOrder(result.nodes, QueryWorkspace::local(), control);
+   }, timeout);
+}
+
+//--------------------------- breadthFirstOrder ---------------------------
+// Submits GraphL::breadthFirstOrder. The int is the timeout in
+// milliseconds, 0 or less for none
+// Preconditions:   none
+// Postconditions:  nodes holds the nodes in breadth first order
+QueryTicket AsyncQueries::breadthFirstOrder(const GraphL& graph,
+                                            int timeout) {
+   const GraphL* g = &graph;
+   return submit([g](QueryControl& control, QueryResult& result) {
+      g->breadthFirstOrder(result.nodes, QueryWorkspace::local(), control);
+   }, timeout);
+}
+
+//------------------------------- submit ----------------------------------
+// Helper for the searches. Makes the ticket, starts the timeout, and
+// queues the search on the pool. A search that waited in the queue past
+// its deadline is not started at all
+// Preconditions:   none
+// Postconditions:  the result is set when the search returns
+QueryTicket AsyncQueries::submit(
+      const function<void(QueryControl&, QueryResult&)>& search,
+      int timeout) {
+   shared_ptr<QueryControl> control(new QueryControl);
+   control->setTimeout(timeout);   //counted from now, not from the start
+   shared_ptr<promise<QueryResult> > done(new promise<QueryResult>);
+
+   QueryTicket ticket;
+   ticket.control = control;
+   ticket.result = done->get_future();
+
+   pool.submit([search, control, done]() {
+      QueryResult result;
+      result.dist = INT_MAX;
+      if (!control->poll())         //cancelled or late while queued
+         search(*control, result);
+      result.status = control->getStatus();
+      done->set_value(result);
+   });
+   return ticket;
+}
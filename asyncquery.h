@@ -0,0 +1,117 @@
+//-----------------------------------------------------------------------//
+// ASYNCQUERY.H                                                          //
+//                                                                       //
+// AsyncQueries runs GraphM and GraphL searches on a WorkerPool and      //
+// hands back a future for each one, so the caller does not have to wait //
+//-----------------------------------------------------------------------//
+// Ticket: every search returns a QueryTicket.  ticket.result is the     //
+//        future of the QueryResult, ticket.control->cancel() asks the   //
+//        search to stop.  A search given a timeout stops by itself once //
+//        that many milliseconds have passed since it was submitted.     //
+//        Either way the result still arrives, with what was found so    //
+//        far and a status saying why it stopped.                        //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- the graph must not be destroyed or changed until the result is  //
+//       ready, findShortestPath is the only search that changes it      //
+//    -- searches use the workspace of the worker thread they run on     //
+//    -- tasks on the pool never wait on a ticket of the same pool       //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#ifndef ASYNCQUERY_H
+#define ASYNCQUERY_H
+#include <future>
+#include <memory>
+#include <functional>
+#include <vector>
+#include "graphm.h"
+#include "graphl.h"
+#include "querycontrol.h"
+#include "workerpool.h"
+using namespace std;
+
+// what a search found
+struct QueryResult {
+   QueryStatus status;       // QUERY_DONE unless it was stopped early
+   int dist;                 // findPath distance, INT_MAX if none
+   vector<int> nodes;        // the path, the nodes found, or visit order
+   vector<int> dists;        // distance of each node, radius and nearest
+};
+
+// handle for one submitted search
+struct QueryTicket {
+   future<QueryResult> result;          // ready when the search ends
+   shared_ptr<QueryControl> control;    // cancel() stops the search
+};
+
+class AsyncQueries {
+
+public:
+//--------------------------- Constructor ---------------------------------
+// Constructor for class AsyncQueries, runs searches on the given pool
+// Preconditions:   the pool outlives this object and every search
+// Postconditions:  none
+AsyncQueries(WorkerPool&);
+
+//------------------------------ findPath ---------------------------------
+// Submits GraphM::findPath from the first node to the second. The last
+// int is the timeout in milliseconds, 0 or less for none
+// Preconditions:   none
+// Postconditions:  dist and nodes hold the distance and path
+QueryTicket findPath(const GraphM&, int, int, int);
+
+//--------------------------- findWithinRadius ----------------------------
+// Submits GraphM::findWithinRadius from the source with the radius. The
+// last int is the timeout in milliseconds, 0 or less for none
+// Preconditions:   none
+// Postconditions:  nodes and dists hold the nodes found, nearest first
+QueryTicket findWithinRadius(const GraphM&, int, int, int);
+
+//----------------------------- findNearest -------------------------------
+// Submits GraphM::findNearest from the source for k nodes. The last int
+// is the timeout in milliseconds, 0 or less for none
+// Preconditions:   none
+// Postconditions:  nodes and dists hold the nodes found, nearest first
+QueryTicket findNearest(const GraphM&, int, int, int);
+
+//-------------------------- findShortestPath -----------------------------
+// Submits GraphM::findShortestPath, which fills the graph's table. The
+// int is the timeout in milliseconds, 0 or less for none
+// Preconditions:   nothing else uses the graph until the result is ready
+// Postconditions:  if stopped part way through, the table is empty.
+//          if stopped before it started, the table is not changed
+QueryTicket findShortestPath(GraphM&, int);
+
+//--------------------------- depthFirstOrder -----------------------------
+// Submits GraphL::depthFirstOrder. The int is the timeout in
+// milliseconds, 0 or less for none
+// Preconditions:   none
+// Postconditions:  nodes holds the nodes in depth first order
+QueryTicket depthFirstOrder(const GraphL&, int);
+
+//--------------------------- breadthFirstOrder ---------------------------
+// Submits GraphL::breadthFirstOrder. The int is the timeout in
+// milliseconds, 0 or less for none
+// Preconditions:   none
+// Postconditions:  nodes holds the nodes in breadth first order
+QueryTicket breadthFirstOrder(const GraphL&, int);
+
+private:
+
+   WorkerPool& pool;                // runs every search
+
+   AsyncQueries(const AsyncQueries&);             // not copyable
+   AsyncQueries& operator=(const AsyncQueries&);
+
+//------------------------------- submit ----------------------------------
+// Helper for the searches. Makes the ticket, starts the timeout, and
+// queues the search on the pool. A search that waited in the queue past
+// its deadline is not started at all
+// Preconditions:   none
+// Postconditions:  the result is set when the search returns
+QueryTicket submit(const function<void(QueryControl&, QueryResult&)>&, int);
+
+};
+
+#endif
@@ -0,0 +1,165 @@
+//-----------------------------------------------------------------------//
+// BULKEDGES.CPP                                                         //
+//                                                                       //
+// Sorts a whole array of edges at once, so GraphM and GraphL can build  //
+// all their edges in one pass instead of one edge at a time             //
+//-----------------------------------------------------------------------//
+// Edge triple: [from node] [to node] [distance], same as one edge line  //
+//        of a data file.                                                //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- node numbers start at 1, so that node numbers are equal to      //
+//       index number                                                    //
+//    -- edges with nodes not in the graph or negative distances are     //
+//       skipped                                                         //
+//    -- edges are sorted with two stable counting sort (radix) passes,  //
+//       to node then from node.  Big arrays are split across threads    //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#include "bulkedges.h"
+#include <thread>
+#include <functional>
+
+// fewest edges worth giving a thread of their own
+static const int EDGES_PER_THREAD = 1 << 16;
+
+// fewest edges a thread's slice needs per counting sort bucket. Every
+// thread clears, sums and walks a bucket for each node, so with fewer
+// edges than this the buckets cost more than the threads save
+static const int EDGES_PER_BUCKET = 4;
+
+//------------------------------ isValid ------------------------------------
+// Returns true if both nodes are in the graph and the distance is not
+// negative
+static bool isValid(const EdgeTriple& edge, int size) {
+   return    edge.from >= 1 && edge.from <= size
+          && edge.to >= 1   && edge.to <= size
+          && edge.dist >= 0;
+}
+
+//------------------------------ runSlices ----------------------------------
+// Runs the work for every slice number [0, threads), each on its own
+// thread, and waits for all of them. A single slice runs on the calling
+// thread
+static void runSlices(int threads, const function<void(int)>& work) {
+   if (threads == 1) {
+      work(0);
+      return;
+   }
+
+   vector<thread> workers;
+   for (int t = 0; t < threads; t++)
+      workers.push_back(thread(work, t));
+   for (int t = 0; t < threads; t++)
+      workers[t].join();
+}
+
+//------------------------------ sliceCount ---------------------------------
+// Returns how many threads to split a counting sort pass of count edges
+// into size + 1 buckets across. Each thread needs EDGES_PER_THREAD edges,
+// and EDGES_PER_BUCKET edges for each bucket, so a graph with many nodes
+// and few edges is sorted on one thread
+static int sliceCount(int count, int size) {
+   long long threads = thread::hardware_concurrency();
+   if (threads > count / EDGES_PER_THREAD)
+      threads = count / EDGES_PER_THREAD;
+   long long perThread = (long long)EDGES_PER_BUCKET * (size + 1);
+   if (threads > count / perThread)
+      threads = count / perThread;
+   return threads < 2 ? 1 : (int)threads;
+}
+
+//---------------------------- countingPass ---------------------------------
+// One stable counting sort pass of edges [0, count) from in to out, by
+// from node if byFrom is true, otherwise by to node. If validate is true,
+// invalid edges are left out. Each thread counts and places one slice of
+// the input; slices are placed in order inside every bucket, so the pass
+// stays stable. Returns the number of edges written to out
+static int countingPass(const EdgeTriple* in, int count, EdgeTriple* out,
+                        int size, bool byFrom, bool validate) {
+   int threads = sliceCount(count, size);
+
+   //place[t][k]: edges with key k in the slice of thread t
+   vector<vector<int> > place(threads, vector<int>(size + 1, 0));
+   vector<int> sliceStart(threads + 1);
+   for (int t = 0; t <= threads; t++)
+      sliceStart[t] = (int)((long long)count * t / threads);
+
+   runSlices(threads, [&](int t) {
+      vector<int>& counts = place[t];
+      for (int i = sliceStart[t]; i < sliceStart[t + 1]; i++) {
+         if (validate && !isValid(in[i], size)) continue;
+         counts[byFrom ? in[i].from : in[i].to]++;
+      }
+   });
+
+   //turn counts into where each thread writes its first edge of key k
+   int total = 0;
+   for (int k = 0; k <= size; k++) {
+      for (int t = 0; t < threads; t++) {
+         int n = place[t][k];
+         place[t][k] = total;
+         total += n;
+      }
+   }
+
+   runSlices(threads, [&](int t) {
+      vector<int>& next = place[t];
+      for (int i = sliceStart[t]; i < sliceStart[t + 1]; i++) {
+         if (validate && !isValid(in[i], size)) continue;
+         out[next[byFrom ? in[i].from : in[i].to]++] = in[i];
+      }
+   });
+
+   return total;
+}
+
+//------------------------------ sortEdges ----------------------------------
+// Copies the valid edges of the array into sorted, ordered by from node
+// then to node, with one edge per from and to pair. first[v] is the index
+// of the first edge of node v in sorted, first[size + 1] is the number of
+// edges. Returns the number of edges that were skipped as invalid
+// Preconditions:   the first int is the number of edges in the array, the
+//          second is the number of nodes in the graph
+// Postconditions:  sorted and first are filled, first has size + 2 entries
+int sortEdges(const EdgeTriple* edges, int count, int size,
+              DuplicatePolicy policy, vector<EdgeTriple>& sorted,
+              vector<int>& first) {
+   sorted.clear();
+   first.assign(size + 2, 0);
+   if (count <= 0 || size <= 0)
+      return count > 0 ? count : 0;
+
+   //radix sort: by to node (dropping invalid edges), then by from node
+   vector<EdgeTriple> byTo(count);
+   int valid = countingPass(edges, count, &byTo[0], size, false, true);
+   if (valid == 0)
+      return count;
+   sorted.resize(valid);
+   countingPass(&byTo[0], valid, &sorted[0], size, true, false);
+
+   //keep one edge per from and to pair. equal pairs are next to each
+   //other, still in array order
+   int kept = 0;
+   for (int i = 0; i < valid; i++) {
+      if (   kept > 0
+          && sorted[kept - 1].from == sorted[i].from
+          && sorted[kept - 1].to == sorted[i].to) {
+         if (policy == KEEP_LAST || sorted[i].dist < sorted[kept - 1].dist)
+            sorted[kept - 1].dist = sorted[i].dist;
+      } else {
+         sorted[kept++] = sorted[i];
+      }
+   }
+   sorted.resize(kept);
+
+   //first[v] is where the edges of v start
+   for (int i = 0; i < kept; i++)
+      first[sorted[i].from + 1]++;
+   for (int v = 1; v <= size; v++)
+      first[v + 1] += first[v];
+   first[0] = 0;
+
+   return count - valid;
+}
@@ -0,0 +1,48 @@
+//-----------------------------------------------------------------------//
+// BULKEDGES.H                                                           //
+//                                                                       //
+// Sorts a whole array of edges at once, so GraphM and GraphL can build  //
+// all their edges in one pass instead of one edge at a time             //
+//-----------------------------------------------------------------------//
+// Edge triple: [from node] [to node] [distance], same as one edge line  //
+//        of a data file.                                                //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- node numbers start at 1, so that node numbers are equal to      //
+//       index number                                                    //
+//    -- edges with nodes not in the graph or negative distances are     //
+//       skipped                                                         //
+//    -- edges are sorted with two stable counting sort (radix) passes,  //
+//       to node then from node.  Big arrays are split across threads    //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#ifndef BULKEDGES_H
+#define BULKEDGES_H
+#include <vector>
+using namespace std;
+
+struct EdgeTriple {
+   int from;                 // node the edge starts at
+   int to;                   // node the edge points to
+   int dist;                 // distance of the edge
+};
+
+// which edge is kept when the same from and to node appear more than once
+enum DuplicatePolicy {
+   KEEP_MIN,                 // the shortest distance
+   KEEP_LAST                 // the one that comes last in the array
+};
+
+//------------------------------ sortEdges ----------------------------------
+// Copies the valid edges of the array into sorted, ordered by from node
+// then to node, with one edge per from and to pair. first[v] is the index
+// of the first edge of node v in sorted, first[size + 1] is the number of
+// edges. Returns the number of edges that were skipped as invalid
+// Preconditions:   the first int is the number of edges in the array, the
+//          second is the number of nodes in the graph
+// Postconditions:  sorted and first are filled, first has size + 2 entries
+int sortEdges(const EdgeTriple*, int, int, DuplicatePolicy,
+              vector<EdgeTriple>&, vector<int>&);
+
+#endif
@@ -0,0 +1,272 @@
+//---------------------------------------------------------------------------
+// checks.cpp
+//---------------------------------------------------------------------------
+// This code checks the queries added to GraphM against slow but obvious
+// answers, on many small random graphs.  It prints one line for each
+// check and returns 1 if any answer was wrong.
+//
+// Assumptions:
+//   -- the random graphs come from a fixed seed, so every run checks the
+//      same graphs
+//   -- the snapshot check writes, then removes, "checks.snap" in the
+//      current directory
+//---------------------------------------------------------------------------
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include "graphm.h"
+#include "graphsnapshot.h"
+#include "bulkedges.h"
+using namespace std;
+
+const int MOST = 40;          // most nodes in a random graph
+const int GRAPHS = 100;       // random graphs for each check
+
+// distance of each edge of a random graph, -1 if no edge, index 0 unused
+typedef int Weights[MOST + 1][MOST + 1];
+
+//------------------------------ randomEdges --------------------------------
+// Returns the edges of a random graph with the given number of nodes,
+// where each edge is there with the given percent chance. weight gets the
+// distance of every edge
+static vector<EdgeTriple> randomEdges(int nodes, int percent,
+                                      Weights weight) {
+   vector<EdgeTriple> edges;
+   for (int i = 1; i <= nodes; i++) {
+      for (int j = 1; j <= nodes; j++) {
+         weight[i][j] = -1;
+         if (i != j && rand() % 100 < percent) {
+            weight[i][j] = rand() % 10;
+            EdgeTriple edge = { i, j, weight[i][j] };
+            edges.push_back(edge);
+         }
+      }
+   }
+   return edges;
+}
+
+//------------------------------ randomGraph --------------------------------
+// Returns a data file, laid out as for GraphM::buildGraph, for a random
+// graph made by randomEdges
+static string randomGraph(int nodes, int percent, Weights weight) {
+   ostringstream data;
+   data << nodes << endl;
+   for (int i = 1; i <= nodes; i++)
+      data << "Node " << i << endl;
+   vector<EdgeTriple> edges = randomEdges(nodes, percent, weight);
+   for (size_t e = 0; e < edges.size(); e++)
+      data << edges[e].from << " " << edges[e].to << " " << edges[e].dist
+           << endl;
+   data << "0 0 0" << endl;
+   return data.str();
+}
+
+//--------------------------------- shown -----------------------------------
+// Returns what display(from, to) prints to cout
+template <class Table>
+static string shown(const Table& table, int from, int to) {
+   ostringstream out;
+   streambuf* old = cout.rdbuf(out.rdbuf());
+   table.display(from, to);
+   cout.rdbuf(old);
+   return out.str();
+}
+
+//---------------------------- checkSnapshot --------------------------------
+// Saves each graph's table, maps it back with GraphSnapshot, and compares
+// every distance and display with GraphM's. The snapshot must be refused
+// once the graph has changed, or with some other graph's hash. Returns
+// the number of wrong answers
+static int checkSnapshot() {
+   const char* file = "checks.snap";
+   Weights weight;
+   int wrong = 0;
+
+   for (int g = 0; g < GRAPHS; g++) {
+      int nodes = 1 + rand() % MOST;
+      istringstream data(randomGraph(nodes, rand() % 30, weight));
+      GraphM* G = new GraphM;             // too big for the stack
+      G->buildGraph(data);
+      G->findShortestPath();
+
+      GraphSnapshot snapshot;
+      if (   !G->saveSnapshot(file)
+          || !snapshot.open(file, G->graphHash())
+          || snapshot.getSize() != nodes) {
+         wrong++;
+      } else {
+         for (int from = 1; from <= nodes; from++) {
+            for (int to = 1; to <= nodes; to++) {
+               int dist = G->getDistance(from, to);
+               if (   snapshot.getDistance(from, to) != dist
+                   || shown(snapshot, from, to) != shown(*G, from, to))
+                  wrong++;
+            }
+         }
+      }
+      snapshot.close();
+
+      //some other graph's hash
+      if (snapshot.open(file, G->graphHash() + 1) || snapshot.isOpen())
+         wrong++;
+
+      //the same graph with one edge changed, no random edge is this long
+      if (nodes >= 2) {
+         G->insertEdge(1, 2, 1000);
+         if (snapshot.open(file, G->graphHash()) || snapshot.isOpen())
+            wrong++;
+      }
+      delete G;
+   }
+   remove(file);
+   return wrong;
+}
+
+//------------------------------ checkReach ---------------------------------
+// Compares isReachable, and whether getDistance finds a path, with the
+// transitive closure of the edges (Warshall). Each graph is checked, then
+// rebuilt with new edges by buildEdges and checked again, so answers left
+// from the old edges are caught. Returns the number of wrong answers
+static int checkReach() {
+   Weights weight;
+   bool reaches[MOST + 1][MOST + 1];
+   int wrong = 0;
+
+   for (int g = 0; g < GRAPHS; g++) {
+      int nodes = 1 + rand() % MOST;
+      istringstream data(randomGraph(nodes, rand() % 15, weight));
+      GraphM* G = new GraphM;             // too big for the stack
+      G->buildGraph(data);
+
+      for (int round = 0; round < 2; round++) {
+         G->findShortestPath();
+
+         //reaches[i][j] if some node k on the way connects them
+         for (int i = 1; i <= nodes; i++)
+            for (int j = 1; j <= nodes; j++)
+               reaches[i][j] = (i == j || weight[i][j] >= 0);
+         for (int k = 1; k <= nodes; k++)
+            for (int i = 1; i <= nodes; i++)
+               for (int j = 1; j <= nodes; j++)
+                  if (reaches[i][k] && reaches[k][j])
+                     reaches[i][j] = true;
+
+         for (int from = 1; from <= nodes; from++) {
+            for (int to = 1; to <= nodes; to++) {
+               bool path = G->getDistance(from, to) != INT_MAX;
+               if (   G->isReachable(from, to) != reaches[from][to]
+                   || path != reaches[from][to])
+                  wrong++;
+            }
+         }
+
+         //new edges for the same nodes, like a nightly rebuild
+         vector<EdgeTriple> edges = randomEdges(nodes, rand() % 15, weight);
+         G->buildEdges(edges.empty() ? NULL : &edges[0], (int)edges.size(),
+                       KEEP_LAST);
+      }
+      delete G;
+   }
+   return wrong;
+}
+
+//------------------------------- allPaths ----------------------------------
+// Adds the distance of every loopless path from node v to the target that
+// does not pass through a used node to dists. dist is the distance so far
+static void allPaths(int v, int target, int nodes, Weights weight,
+                     vector<bool>& used, int dist, vector<int>& dists) {
+   if (v == target) {
+      dists.push_back(dist);
+      return;
+   }
+   for (int w = 1; w <= nodes; w++) {
+      if (weight[v][w] < 0 || used[w]) continue;
+      used[w] = true;
+      allPaths(w, target, nodes, weight, used, dist + weight[v][w], dists);
+      used[w] = false;
+   }
+}
+
+//------------------------------ checkKPaths --------------------------------
+// Compares findKShortestPaths with every loopless path, found one by one,
+// on graphs small enough to list them all. The distances must be the k
+// shortest, and each path must be a different loopless path of the edges
+// with that distance. Returns the number of wrong answers
+static int checkKPaths() {
+   const int SMALL = 8;               // most nodes, paths grow as n!
+   Weights weight;
+   int wrong = 0;
+
+   for (int g = 0; g < GRAPHS; g++) {
+      int nodes = 1 + rand() % SMALL;
+      istringstream data(randomGraph(nodes, 20 + rand() % 40, weight));
+      GraphM* G = new GraphM;             // too big for the stack
+      G->buildGraph(data);
+      G->findShortestPath();
+
+      for (int from = 1; from <= nodes; from++) {
+         for (int to = 1; to <= nodes; to++) {
+            vector<int> all;
+            vector<bool> used(nodes + 1, false);
+            used[from] = true;
+            allPaths(from, to, nodes, weight, used, 0, all);
+            sort(all.begin(), all.end());
+
+            int k = 1 + rand() % 12;
+            vector<vector<int> > paths;
+            vector<int> dists;
+            int found = G->findKShortestPaths(from, to, k, paths, dists);
+            if (found != min(k, (int)all.size())) {
+               wrong++;
+               continue;
+            }
+
+            set<vector<int> > seen;
+            for (int p = 0; p < found; p++) {
+               const vector<int>& path = paths[p];
+               set<int> onPath(path.begin(), path.end());
+               bool ok =    dists[p] == all[p]
+                         && path.front() == from && path.back() == to
+                         && onPath.size() == path.size()     //loopless
+                         && seen.insert(path).second;        //not repeated
+               int dist = 0;
+               for (size_t i = 0; ok && i + 1 < path.size(); i++) {
+                  ok = weight[path[i]][path[i + 1]] >= 0;    //edge exists
+                  dist += weight[path[i]][path[i + 1]];
+               }
+               if (!ok || dist != dists[p]) {
+                  wrong++;
+                  break;
+               }
+            }
+         }
+      }
+      delete G;
+   }
+   return wrong;
+}
+
+int main() {
+   srand(343);
+   int wrong = 0;
+   int found;
+
+   found = checkSnapshot();
+   cout << "snapshot round trip: " << found << " wrong" << endl;
+   wrong += found;
+
+   found = checkReach();
+   cout << "reachability: " << found << " wrong" << endl;
+   wrong += found;
+
+   found = checkKPaths();
+   cout << "k shortest paths: " << found << " wrong" << endl;
+   wrong += found;
+
+   return wrong == 0 ? 0 : 1;
+}
@@ -0,0 +1,531 @@
+//-----------------------------------------------------------------------//
+// GRAPH.CPP                                                             //
+//                                                                       //
+// Graph holds a weighted or unweighted graph and can run Dijkstra,      //
+// depth first search and breadth first search on it.  It picks how to   //
+// store the edges by how dense the graph is                             //
+//-----------------------------------------------------------------------//
+// Layout: chosen every time the edges are built.                        //
+//    -- sparse: compressed sparse row.  Each node's edges are one run   //
+//       of the adj and weight arrays, in order of to node               //
+//    -- dense: a matrix of distances plus one row of bits per node,     //
+//       bit w set if there is an edge to w.  Searches scan the bits a   //
+//       64 bit word at a time, skipping words with no edges or with     //
+//       every node already visited                                      //
+//    -- dense is used when at least 1 in DENSE_SHARE of all node pairs  //
+//       has an edge, and the graph has at most MAXDENSE nodes           //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- every search gives the same answer with either layout.  Edges   //
+//       are always looked at in order of to node                        //
+//    -- data files are laid out as for GraphM (weighted) or GraphL      //
+//       (unweighted), see buildGraph.  Unweighted edges have distance 1 //
+//    -- one edge per pair of nodes, the last one read is kept.  Edges   //
+//       with nodes not in the graph or negative distances are skipped   //
+//    -- no limit on the number of nodes, node numbers start at 1        //
+//    -- searches are const and keep their scratch data in a             //
+//       QueryWorkspace, so many threads can search one graph at once    //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#include "graph.h"
+#include <algorithm>
+#include <functional>
+#include <string>
+
+//--------------------------- Constructor ---------------------------------
+// Default constructor for class Graph
+// Preconditions:   none
+// Postconditions:  no nodes and no edges, size is 0
+Graph::Graph() {
+   size = 0;
+   edgeCount = 0;
+   dense = false;
+   words = 0;
+}
+
+//----------------------------- buildGraph --------------------------------
+// Builds the graph from a data file. If the bool is true each edge line
+// is [node1] [node2] [distance] and 0 0 0 ends the edges, as in
+// GraphM::buildGraph. If false each edge line is [node1] [node2] and 0 0
+// ends the edges, as in GraphL::buildGraph
+// Preconditions:   none
+// Assumptions: node names are less than 51 characters in length
+// Postconditions:  nodes and edges are inputted into Graph, and the
+//          layout is chosen
+void Graph::buildGraph(istream& infile, bool weighted) {
+   if (!buildNodes(infile)) return;  // stop if no more data
+
+   // read the edge data, bad edges are skipped by buildEdges
+   vector<EdgeTriple> edges;
+   for (;;) {
+      EdgeTriple edge = { 0, 0, 1 };
+      infile >> edge.from >> edge.to;
+      if (weighted)
+         infile >> edge.dist;
+      if (!infile || (edge.from == 0 && edge.to == 0))  //end of edge data
+         break;
+      edges.push_back(edge);
+   }
+   buildEdges(edges.empty() ? NULL : &edges[0], (int)edges.size(), weighted);
+}
+
+//----------------------------- buildNodes --------------------------------
+// Reads the number of nodes and the node names, the first part of the
+// buildGraph input, and leaves the edges unread. Returns false if there
+// was no more data
+// Preconditions:   none
+// Assumptions: node names are less than 51 characters in length
+// Postconditions:  Graph is emptied and holds the nodes, with no edges
+bool Graph::buildNodes(istream& infile) {
+   makeEmpty();               // clear the graph of memory
+
+   int nodes = 0;
+   infile >> nodes;           // read the number of nodes
+   if (infile.eof() || nodes < 0) return false;  // stop if no more data
+
+   string s;                  // used to read through to end of line
+   getline(infile, s);
+
+   // read graph node information
+   data.resize(nodes + 1);
+   for (int i = 1; i <= nodes; i++)
+      data[i].setData(infile);
+   size = nodes;
+   buildEdges(NULL, 0, true);   // no edges yet, but a valid layout
+   return true;
+}
+
+//----------------------------- buildEdges --------------------------------
+// Replaces every edge of Graph with the edges in the array, and chooses
+// the layout. Returns the number of edges stored. If the bool is false
+// the distances in the array are ignored and every edge has distance 1
+// Preconditions:   the nodes are already in Graph (see buildNodes)
+// Postconditions:  Graph holds exactly the valid edges of the array
+int Graph::buildEdges(const EdgeTriple* edges, int count, bool weighted) {
+   vector<EdgeTriple> sorted;
+   vector<int> start;
+   if (weighted) {
+      sortEdges(edges, count, size, KEEP_LAST, sorted, start);
+   } else {
+      //unweighted, so a file's missing or junk distance never drops an edge
+      vector<EdgeTriple> ones(edges, edges + count);
+      for (size_t i = 0; i < ones.size(); i++)
+         ones[i].dist = 1;
+      sortEdges(ones.empty() ? NULL : &ones[0], count, size, KEEP_LAST,
+                sorted, start);
+   }
+   edgeCount = (int)sorted.size();
+
+   //free the old layout, swap releases the memory, clear does not
+   vector<int>().swap(first);
+   vector<int>().swap(adj);
+   vector<int>().swap(weight);
+   vector<unsigned long long>().swap(bits);
+   vector<int>().swap(matrix);
+   words = 0;
+
+   long long pairs = (long long)size * size;
+   dense = size > 0 && size <= MAXDENSE
+        && (long long)edgeCount * DENSE_SHARE >= pairs;
+
+   if (dense) {
+      //bit w of a row is node w, bit 0 is never set
+      words = (size + 1 + 63) / 64;
+      bits.assign((size_t)(size + 1) * words, 0);
+      matrix.assign((size_t)(size + 1) * (size + 1), INT_MAX);
+      for (int e = 0; e < edgeCount; e++) {
+         int v = sorted[e].from;
+         int w = sorted[e].to;
+         bits[(size_t)v * words + w / 64] |= 1ULL << (w % 64);
+         matrix[(size_t)v * (size + 1) + w] = sorted[e].dist;
+      }
+   } else {
+      //sorted by from node then to node, so it already is the CSR order
+      first.swap(start);
+      adj.resize(edgeCount);
+      weight.resize(edgeCount);
+      for (int e = 0; e < edgeCount; e++) {
+         adj[e] = sorted[e].to;
+         weight[e] = sorted[e].dist;
+      }
+   }
+   return edgeCount;
+}
+
+//----------------------------- makeEmpty ---------------------------------
+// Removes every node and edge
+// Preconditions:   none
+// Postconditions:  all data is set to construction values
+void Graph::makeEmpty() {
+   size = 0;
+   edgeCount = 0;
+   dense = false;
+   words = 0;
+   vector<NodeData>().swap(data);
+   vector<int>().swap(first);
+   vector<int>().swap(adj);
+   vector<int>().swap(weight);
+   vector<unsigned long long>().swap(bits);
+   vector<int>().swap(matrix);
+}
+
+//------------------------------ getSize ----------------------------------
+// Returns the number of nodes
+// Preconditions:   none
+// Postconditions:  none
+int Graph::getSize() const {
+   return size;
+}
+
+//---------------------------- getEdgeCount -------------------------------
+// Returns the number of edges
+// Preconditions:   none
+// Postconditions:  none
+int Graph::getEdgeCount() const {
+   return edgeCount;
+}
+
+//------------------------------ isDense ----------------------------------
+// Returns true if the edges are stored as a matrix and bit rows, false
+// if they are stored as compressed sparse rows
+// Preconditions:   none
+// Postconditions:  none
+bool Graph::isDense() const {
+   return dense;
+}
+
+//------------------------------ getEdge ----------------------------------
+// Returns the distance of the edge from one node to another, INT_MAX if
+// there is no edge or the nodes are not in Graph
+// Preconditions:   none
+// Postconditions:  none
+int Graph::getEdge(int fromNode, int toNode) const {
+   //if the nodes inputted are not in Graph
+   if (fromNode > size || fromNode < 1 || toNode > size || toNode < 1)
+      return INT_MAX;
+
+   if (dense)
+      return matrix[(size_t)fromNode * (size + 1) + toNode];
+
+   //the edges of a node are in order of to node
+   vector<int>::const_iterator begin = adj.begin() + first[fromNode];
+   vector<int>::const_iterator end = adj.begin() + first[fromNode + 1];
+   vector<int>::const_iterator found = lower_bound(begin, end, toNode);
+   if (found == end || *found != toNode)
+      return INT_MAX;
+   return weight[found - adj.begin()];
+}
+
+//-------------------------- findShortestPath -----------------------------
+// Dijkstra from the source to every node. Fills dist and path, indexed by
+// node, with the shortest distance (INT_MAX if not reached) and the node
+// before it on the path (0 if none). Returns the number of nodes reached,
+// the source included. With a QueryControl the search can be stopped
+// early, the nodes not settled yet then read as not reached
+// Preconditions:   none
+// Postconditions:  dist and path have size + 1 entries
+int Graph::findShortestPath(int source, vector<int>& dist,
+                            vector<int>& path) const {
+   QueryControl control;            //never cancelled, no deadline
+   return findShortestPath(source, dist, path, QueryWorkspace::local(),
+                           control);
+}
+
+int Graph::findShortestPath(int source, vector<int>& dist,
+                            vector<int>& path, QueryWorkspace& work,
+                            QueryControl& control) const {
+   dist.assign(size + 1, INT_MAX);
+   path.assign(size + 1, 0);
+
+   //if the source is not in Graph
+   if (source > size || source < 1)
+      return 0;
+
+   dijkstra(source, 0, work, &control);
+   int reached = 0;
+   for (int v = 1; v <= size; v++) {
+      if (work.done[v] == work.epoch) {
+         dist[v] = work.dist[v];
+         path[v] = work.path[v];
+         reached++;
+      }
+   }
+   return reached;
+}
+
+//------------------------------ findPath ---------------------------------
+// Finds the shortest path from one node to another, stopping as soon as
+// the second is settled. Fills the vector with the path, first node
+// first, and returns the distance, INT_MAX if there is no path, the nodes
+// are not in Graph, or the search was stopped
+// Preconditions:   none
+// Postconditions:  none
+int Graph::findPath(int fromNode, int toNode, vector<int>& nodes) const {
+   QueryControl control;            //never cancelled, no deadline
+   return findPath(fromNode, toNode, nodes, QueryWorkspace::local(),
+                   control);
+}
+
+int Graph::findPath(int fromNode, int toNode, vector<int>& nodes,
+                    QueryWorkspace& work, QueryControl& control) const {
+   nodes.clear();
+
+   //if the nodes inputted are not in Graph
+   if (fromNode > size || fromNode < 1 || toNode > size || toNode < 1)
+      return INT_MAX;
+
+   dijkstra(fromNode, toNode, work, &control);
+   if (work.done[toNode] != work.epoch)     //never settled, or stopped
+      return INT_MAX;
+
+   //walk back from toNode to fromNode through the workspace
+   for (int w = toNode; w != fromNode; w = work.path[w])
+      nodes.push_back(w);
+   nodes.push_back(fromNode);
+   reverse(nodes.begin(), nodes.end());
+   return work.dist[toNode];
+}
+
+//--------------------------- depthFirstOrder -----------------------------
+// Fills the vector with all of the nodes in depth first order, and
+// returns the number of nodes. Nodes not reached from node 1 start a new
+// search, in node order. With a QueryControl the search can be stopped
+// early, the vector then holds the nodes visited so far
+// Assumptions: source is node 1
+// Preconditions:   none
+// Postconditions:  none
+int Graph::depthFirstOrder(vector<int>& order) const {
+   QueryControl control;            //never cancelled, no deadline
+   return depthFirstOrder(order, QueryWorkspace::local(), control);
+}
+
+int Graph::depthFirstOrder(vector<int>& order, QueryWorkspace& work,
+                           QueryControl& control) const {
+   order.clear();
+   work.begin(size);
+   work.bits.assign(words, 0);      //visited bits, dense layout only
+
+   //each stack entry is (node, where to look for its next edge): an edge
+   //index when sparse, a node number when dense
+   vector<pair<int, int> >& stack = work.heap;
+   for (int i = 1; i <= size; i++) {
+      if (work.done[i] == work.epoch) continue;
+      work.done[i] = work.epoch;
+      if (dense) work.bits[i / 64] |= 1ULL << (i % 64);
+      order.push_back(i);
+      stack.push_back(make_pair(i, dense ? 1 : first[i]));
+
+      while (!stack.empty()) {
+         if (control.poll()) return (int)order.size();  //stopped by caller
+
+         int v = stack.back().first;
+         int& next = stack.back().second;
+         int w = 0;                 //next edge node not visited, 0 if none
+         if (dense) {
+            //first set bit at or after next, in the row but not visited
+            const unsigned long long* row = &bits[(size_t)v * words];
+            int k = next / 64;
+            unsigned long long m = 0;
+            if (next <= size)
+               m = row[k] & ~work.bits[k] & (~0ULL << (next % 64));
+            while (m == 0 && ++k < words)
+               m = row[k] & ~work.bits[k];
+            if (m != 0) {
+               w = k * 64 + __builtin_ctzll(m);
+               work.bits[k] |= 1ULL << (w % 64);
+               next = w + 1;
+            }
+         } else {
+            for (; next < first[v + 1]; next++) {
+               if (work.done[adj[next]] != work.epoch) {
+                  w = adj[next++];
+                  break;
+               }
+            }
+         }
+
+         if (w == 0) {              //every edge node visited, go back up
+            stack.pop_back();
+            continue;
+         }
+         work.done[w] = work.epoch;
+         order.push_back(w);
+         stack.push_back(make_pair(w, dense ? 1 : first[w]));
+      }
+   }
+   return (int)order.size();
+}
+
+//--------------------------- breadthFirstOrder ---------------------------
+// Fills the vector with all of the nodes in breadth first order, and
+// returns the number of nodes. Nodes not reached from node 1 start a new
+// search, in node order. With a QueryControl the search can be stopped
+// early, the vector then holds the nodes visited so far
+// Assumptions: source is node 1
+// Preconditions:   none
+// Postconditions:  none
+int Graph::breadthFirstOrder(vector<int>& order) const {
+   QueryControl control;            //never cancelled, no deadline
+   return breadthFirstOrder(order, QueryWorkspace::local(), control);
+}
+
+int Graph::breadthFirstOrder(vector<int>& order, QueryWorkspace& work,
+                             QueryControl& control) const {
+   order.clear();
+   work.begin(size);
+   work.bits.assign(words, 0);      //visited bits, dense layout only
+
+   //order is also the queue, next is the node to visit next
+   size_t next = 0;
+   for (int i = 1; i <= size; i++) {
+      if (work.done[i] == work.epoch) continue;
+      if (dense && (work.bits[i / 64] >> (i % 64) & 1)) continue;
+      work.done[i] = work.epoch;
+      if (dense) work.bits[i / 64] |= 1ULL << (i % 64);
+      order.push_back(i);
+
+      while (next < order.size()) {
+         if (control.poll()) return (int)order.size();  //stopped by caller
+
+         int v = order[next++];
+         if (dense) {
+            //every edge node not visited yet, a whole word at a time
+            const unsigned long long* row = &bits[(size_t)v * words];
+            for (int k = 0; k < words; k++) {
+               unsigned long long m = row[k] & ~work.bits[k];
+               work.bits[k] |= m;
+               for (; m != 0; m &= m - 1)
+                  order.push_back(k * 64 + __builtin_ctzll(m));
+            }
+         } else {
+            for (int e = first[v]; e < first[v + 1]; e++) {
+               if (work.done[adj[e]] != work.epoch) {
+                  work.done[adj[e]] = work.epoch;
+                  order.push_back(adj[e]);
+               }
+            }
+         }
+      }
+   }
+   return (int)order.size();
+}
+
+//------------------------------ displayGraph -----------------------------
+// Displays through cout all of the nodes and edges inbetween them, with
+// their distances. Extra blank line included, like GraphL
+// Preconditions: none
+// Postconditions: none
+void Graph::displayGraph() const {
+   cout << "Graph:" << (dense ? " (dense)" : " (sparse)") << endl;
+   for (int i = 1; i <= size; i++) {
+      //print node number and name
+      cout << "Node " << setw(9) << left << i << data[i] << endl;
+
+      //print edges, in order of to node
+      for (int j = 1; j <= size; j++) {
+         if (dense && !(bits[(size_t)i * words + j / 64] >> (j % 64) & 1))
+            continue;
+         int dist = getEdge(i, j);
+         if (dist < INT_MAX)
+            cout << "  edge " << i << " " << j << " " << dist << endl;
+      }
+   }
+   cout << right << endl; //extra blank line
+}
+
+//--------------------------- depthFirstSearch ----------------------------
+// Displays through cout all of the nodes in depth first order. Extra
+// blank line included, like GraphL
+// Assumptions: source is node 1
+// Preconditions: none
+// Postconditions: none
+void Graph::depthFirstSearch() const {
+   vector<int> order;
+   depthFirstOrder(order);
+
+   cout << "Depth First Search: ";
+   for (size_t i = 0; i < order.size(); i++)
+      cout << order[i] << " ";
+   cout << endl << endl; //extra blank line
+}
+
+//-------------------------- breadthFirstSearch ---------------------------
+// Displays through cout all of the nodes in breadth first order. Extra
+// blank line included, like GraphL
+// Assumptions: source is node 1
+// Preconditions: none
+// Postconditions: none
+void Graph::breadthFirstSearch() const {
+   vector<int> order;
+   breadthFirstOrder(order);
+
+   cout << "Breadth First Search: ";
+   for (size_t i = 0; i < order.size(); i++)
+      cout << order[i] << " ";
+   cout << endl << endl; //extra blank line
+}
+
+//------------------------------ dijkstra ---------------------------------
+// Helper for findShortestPath and findPath. Dijkstra from the source
+// that stops when the target (if not 0) is settled. The control, if not
+// NULL, is polled once for every node settled
+// Preconditions:   the source is in Graph
+// Postconditions:  the workspace holds dist and path of every node
+//          settled, marked done
+void Graph::dijkstra(int source, int target, QueryWorkspace& work,
+                     QueryControl* control) const {
+   work.begin(size);
+   const unsigned int epoch = work.epoch;
+   vector<pair<int, int> >& heap = work.heap;
+   work.seen[source] = epoch;
+   work.dist[source] = 0;
+   work.path[source] = 0;
+   heap.push_back(make_pair(0, source));
+
+   while (!heap.empty()) {
+      //take the closest node not settled yet
+      pop_heap(heap.begin(), heap.end(), greater<pair<int, int> >());
+      int d = heap.back().first;
+      int v = heap.back().second;
+      heap.pop_back();
+      if (work.done[v] == epoch) continue;  //older, longer entry for v
+      if (control != NULL && control->poll()) break;  //stopped by caller
+
+      work.done[v] = epoch;
+      if (v == target) break;               //found the path asked for
+
+      //for each edge node not settled, in order of to node
+      int e = dense ? 0 : first[v];
+      int end = dense ? 0 : first[v + 1];
+      int k = 0;
+      unsigned long long m = dense ? bits[(size_t)v * words] : 0;
+      for (;;) {
+         int w, cost;
+         if (dense) {
+            while (m == 0 && ++k < words)     //skip words with no edges
+               m = bits[(size_t)v * words + k];
+            if (m == 0) break;
+            w = k * 64 + __builtin_ctzll(m);
+            m &= m - 1;
+            cost = matrix[(size_t)v * (size + 1) + w];
+         } else {
+            if (e == end) break;
+            w = adj[e];
+            cost = weight[e++];
+         }
+         if (work.done[w] == epoch || cost > INT_MAX - d)  //no overflow
+            continue;
+
+         //if going through v is better
+         int newDist = d + cost;
+         if (work.seen[w] != epoch || newDist < work.dist[w]) {
+            work.seen[w] = epoch;
+            work.dist[w] = newDist;
+            work.path[w] = v;
+            heap.push_back(make_pair(newDist, w));
+            push_heap(heap.begin(), heap.end(), greater<pair<int, int> >());
+         }
+      }
+   }
+}
@@ -0,0 +1,210 @@
+//-----------------------------------------------------------------------//
+// GRAPH.H                                                               //
+//                                                                       //
+// Graph holds a weighted or unweighted graph and can run Dijkstra,      //
+// depth first search and breadth first search on it.  It picks how to   //
+// store the edges by how dense the graph is                             //
+//-----------------------------------------------------------------------//
+// Layout: chosen every time the edges are built.                        //
+//    -- sparse: compressed sparse row.  Each node's edges are one run   //
+//       of the adj and weight arrays, in order of to node               //
+//    -- dense: a matrix of distances plus one row of bits per node,     //
+//       bit w set if there is an edge to w.  Searches scan the bits a   //
+//       64 bit word at a time, skipping words with no edges or with     //
+//       every node already visited                                      //
+//    -- dense is used when at least 1 in DENSE_SHARE of all node pairs  //
+//       has an edge, and the graph has at most MAXDENSE nodes           //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- every search gives the same answer with either layout.  Edges   //
+//       are always looked at in order of to node                        //
+//    -- data files are laid out as for GraphM (weighted) or GraphL      //
+//       (unweighted), see buildGraph.  Unweighted edges have distance 1 //
+//    -- one edge per pair of nodes, the last one read is kept.  Edges   //
+//       with nodes not in the graph or negative distances are skipped   //
+//    -- no limit on the number of nodes, node numbers start at 1        //
+//    -- searches are const and keep their scratch data in a             //
+//       QueryWorkspace, so many threads can search one graph at once    //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#ifndef GRAPH_H
+#define GRAPH_H
+#include <iostream>
+#include <iomanip>
+#include <limits.h>
+#include <vector>
+#include "nodedata.h"
+#include "bulkedges.h"
+#include "queryworkspace.h"
+#include "querycontrol.h"
+using namespace std;
+
+class Graph {
+
+public:
+//--------------------------- Constructor ---------------------------------
+// Default constructor for class Graph
+// Preconditions:   none
+// Postconditions:  no nodes and no edges, size is 0
+Graph();
+
+//----------------------------- buildGraph --------------------------------
+// Builds the graph from a data file. If the bool is true each edge line
+// is [node1] [node2] [distance] and 0 0 0 ends the edges, as in
+// GraphM::buildGraph. If false each edge line is [node1] [node2] and 0 0
+// ends the edges, as in GraphL::buildGraph
+// Preconditions:   none
+// Assumptions: node names are less than 51 characters in length
+// Postconditions:  nodes and edges are inputted into Graph, and the
+//          layout is chosen
+void buildGraph(istream&, bool);
+
+//----------------------------- buildNodes --------------------------------
+// Reads the number of nodes and the node names, the first part of the
+// buildGraph input, and leaves the edges unread. Returns false if there
+// was no more data
+// Preconditions:   none
+// Assumptions: node names are less than 51 characters in length
+// Postconditions:  Graph is emptied and holds the nodes, with no edges
+bool buildNodes(istream&);
+
+//----------------------------- buildEdges --------------------------------
+// Replaces every edge of Graph with the edges in the array, and chooses
+// the layout. Returns the number of edges stored. If the bool is false
+// the distances in the array are ignored and every edge has distance 1
+// Preconditions:   the nodes are already in Graph (see buildNodes)
+// Postconditions:  Graph holds exactly the valid edges of the array
+int buildEdges(const EdgeTriple*, int, bool);
+
+//----------------------------- makeEmpty ---------------------------------
+// Removes every node and edge
+// Preconditions:   none
+// Postconditions:  all data is set to construction values
+void makeEmpty();
+
+//------------------------------ getSize ----------------------------------
+// Returns the number of nodes
+// Preconditions:   none
+// Postconditions:  none
+int getSize() const;
+
+//---------------------------- getEdgeCount -------------------------------
+// Returns the number of edges
+// Preconditions:   none
+// Postconditions:  none
+int getEdgeCount() const;
+
+//------------------------------ isDense ----------------------------------
+// Returns true if the edges are stored as a matrix and bit rows, false
+// if they are stored as compressed sparse rows
+// Preconditions:   none
+// Postconditions:  none
+bool isDense() const;
+
+//------------------------------ getEdge ----------------------------------
+// Returns the distance of the edge from one node to another, INT_MAX if
+// there is no edge or the nodes are not in Graph
+// Preconditions:   none
+// Postconditions:  none
+int getEdge(int, int) const;
+
+//-------------------------- findShortestPath -----------------------------
+// Dijkstra from the source to every node. Fills dist and path, indexed by
+// node, with the shortest distance (INT_MAX if not reached) and the node
+// before it on the path (0 if none). Returns the number of nodes reached,
+// the source included. With a QueryControl the search can be stopped
+// early, the nodes not settled yet then read as not reached
+// Preconditions:   none
+// Postconditions:  dist and path have size + 1 entries
+int findShortestPath(int, vector<int>&, vector<int>&) const;
+int findShortestPath(int, vector<int>&, vector<int>&, QueryWorkspace&,
+                     QueryControl&) const;
+
+//------------------------------ findPath ---------------------------------
+// Finds the shortest path from one node to another, stopping as soon as
+// the second is settled. Fills the vector with the path, first node
+// first, and returns the distance, INT_MAX if there is no path, the nodes
+// are not in Graph, or the search was stopped
+// Preconditions:   none
+// Postconditions:  none
+int findPath(int, int, vector<int>&) const;
+int findPath(int, int, vector<int>&, QueryWorkspace&, QueryControl&) const;
+
+//--------------------------- depthFirstOrder -----------------------------
+// Fills the vector with all of the nodes in depth first order, and
+// returns the number of nodes. Nodes not reached from node 1 start a new
+// search, in node order. With a QueryControl the search can be stopped
+// early, the vector then holds the nodes visited so far
+// Assumptions: source is node 1
+// Preconditions:   none
+// Postconditions:  none
+int depthFirstOrder(vector<int>&) const;
+int depthFirstOrder(vector<int>&, QueryWorkspace&, QueryControl&) const;
+
+//--------------------------- breadthFirstOrder ---------------------------
+// Fills the vector with all of the nodes in breadth first order, and
+// returns the number of nodes. Nodes not reached from node 1 start a new
+// search, in node order. With a QueryControl the search can be stopped
+// early, the vector then holds the nodes visited so far
+// Assumptions: source is node 1
+// Preconditions:   none
+// Postconditions:  none
+int breadthFirstOrder(vector<int>&) const;
+int breadthFirstOrder(vector<int>&, QueryWorkspace&, QueryControl&) const;
+
+//------------------------------ displayGraph -----------------------------
+// Displays through cout all of the nodes and edges inbetween them, with
+// their distances. Extra blank line included, like GraphL
+// Preconditions: none
+// Postconditions: none
+void displayGraph() const;
+
+//--------------------------- depthFirstSearch ----------------------------
+// Displays through cout all of the nodes in depth first order. Extra
+// blank line included, like GraphL
+// Assumptions: source is node 1
+// Preconditions: none
+// Postconditions: none
+void depthFirstSearch() const;
+
+//-------------------------- breadthFirstSearch ---------------------------
+// Displays through cout all of the nodes in breadth first order. Extra
+// blank line included, like GraphL
+// Assumptions: source is node 1
+// Preconditions: none
+// Postconditions: none
+void breadthFirstSearch() const;
+
+private:
+
+   static const int DENSE_SHARE = 8;    // dense if edges >= pairs / this
+   static const int MAXDENSE = 4096;    // most nodes for a dense matrix
+
+   int size;                        // number of nodes in the graph
+   int edgeCount;                   // number of edges in the graph
+   bool dense;                      // which layout the edges are in
+   vector<NodeData> data;           // node names, from index 1
+
+   // sparse layout, node v's edges are [first[v], first[v + 1])
+   vector<int> first;               // start of each node's edges
+   vector<int> adj;                 // to node of each edge
+   vector<int> weight;              // distance of each edge
+
+   // dense layout, node v's row starts at v * words and v * (size + 1)
+   int words;                       // 64 bit words in one bit row
+   vector<unsigned long long> bits; // bit w of row v set if edge v to w
+   vector<int> matrix;              // distance of each edge, if bit set
+
+//------------------------------ dijkstra ---------------------------------
+// Helper for findShortestPath and findPath. Dijkstra from the source
+// that stops when the target (if not 0) is settled. The control, if not
+// NULL, is polled once for every node settled
+// Preconditions:   the source is in Graph
+// Postconditions:  the workspace holds dist and path of every node
+//          settled, marked done
+void dijkstra(int, int, QueryWorkspace&, QueryControl*) const;
+
+};
+
+#endif
@@ -0,0 +1,88 @@
+//---------------------------------------------------------------------------
+// graphd.cpp
+//---------------------------------------------------------------------------
+// Query daemon.  Loads the first graph in a data file into GraphM once,
+// runs findShortestPath, then answers requests until stopped (see
+// queryserver.h for the request and reply lines).
+//
+// Usage:
+//   graphd datafile [-s socketpath] [-w workers]
+//     -s  listen on a Unix domain socket, otherwise read stdin
+//     -w  number of worker threads, default one per hardware thread
+//
+// Assumptions:
+//   -- the data file is formatted as described in GraphM::buildGraph,
+//      bad edge lines are skipped and reported to cerr
+//   -- the daemon exits with an error if the file has no graph, or the
+//      graph has more nodes than GraphM can hold
+//   -- counters are written to cerr when the daemon stops
+//---------------------------------------------------------------------------
+
+#include <iostream>
+#include <string>
+#include <stdlib.h>
+#include <signal.h>
+#include "graphm.h"
+#include "queryserver.h"
+#include "graphparser.h"
+using namespace std;
+
+static QueryServer* server = NULL;    // for the signal handler
+static GraphM graph;                  // too big for the stack
+
+//-------------------------------- stopServer -------------------------------
+// Signal handler, lets serveSocket or serveStream return, so the socket
+// file is removed and the counters are written
+static void stopServer(int) {
+   if (server != NULL)
+      server->stop();
+}
+
+int main(int argc, char* argv[]) {
+   string socketPath;
+   int workers = 0;
+   if (argc < 2) {
+      cerr << "usage: graphd datafile [-s socketpath] [-w workers]" << endl;
+      return 1;
+   }
+   for (int i = 2; i + 1 < argc; i += 2) {
+      string flag = argv[i];
+      if (flag == "-s") socketPath = argv[i + 1];
+      else if (flag == "-w") workers = atoi(argv[i + 1]);
+   }
+
+   GraphParser parser(workers);
+   if (!parser.open(argv[1])) {
+      cerr << "File could not be opened." << endl;
+      return 1;
+   }
+   bool loaded = parser.nextGraph(graph);
+   const vector<ParseError>& errors = parser.getErrors();
+   for (size_t i = 0; i < errors.size(); i++)
+      cerr << argv[1] << ":" << errors[i].line << ": " << errors[i].reason
+           << endl;
+   if (!loaded) {                     //no graph, or too many nodes
+      cerr << "Graph could not be loaded." << endl;
+      return 1;
+   }
+   graph.findShortestPath();
+
+   QueryServer queries(graph, workers);
+   server = &queries;
+   signal(SIGINT, stopServer);
+   signal(SIGTERM, stopServer);
+   signal(SIGPIPE, SIG_IGN);
+
+   if (socketPath.empty()) {
+      ios::sync_with_stdio(false);    //lets serveStream see buffered lines
+      queries.serveStream(cin, cout);
+   } else if (!queries.serveSocket(socketPath)) {
+      cerr << "Socket could not be opened." << endl;
+      return 1;
+   }
+
+   queries.displayStats(cerr);
+   cerr << endl;
+   server = NULL;
+   return 0;
+}
@@ -0,0 +1,509 @@
+//-----------------------------------------------------------------------//
+// GRAPHEXTERNAL.CPP                                                     //
+//                                                                       //
+// GraphExternal runs Dijkstra's shortest path algorithm on graphs whose //
+// edges do not fit in memory.  Edges stay in a file on disk, only the   //
+// distance, path and heap of each node are kept in memory               //
+//-----------------------------------------------------------------------//
+// Edge file: a compressed sparse row (CSR) file made by buildEdgeFile.  //
+//        It holds a header, the index of the first edge of each node,   //
+//        then every edge as [to node] [distance], grouped by from node  //
+//        and sorted by to node.  The file is memory mapped and the      //
+//        edges of a node are read in place when the node is settled.    //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- node numbers start at 1, like GraphM and GraphL                 //
+//    -- does not accept negative distances                              //
+//    -- repeated edges between two nodes are all kept, the shortest one //
+//       is the one a path uses                                          //
+//    -- the edge file is read on a machine with the same byte order and //
+//       int size as the machine that wrote it                           //
+//    -- the kernel is told not to read ahead in the edges, instead the  //
+//       edges of the next node to be settled are prefetched             //
+//    -- buildEdgeFile writes sorted runs that fit in its memory budget  //
+//       to temporary files beside the edge file, then merges them       //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#include "graphexternal.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <functional>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+
+// one run's next edge waiting to be merged, see mergeRuns
+struct RunHead {
+   TempEdge edge;
+   int run;                  // index of the run the edge came from
+};
+
+// page faults are counted for the calling thread only, so queries run on
+// other threads at the same time do not add to this one's count
+#ifdef RUSAGE_THREAD
+static const int FAULT_WHO = RUSAGE_THREAD;
+#else
+static const int FAULT_WHO = RUSAGE_SELF;
+#endif
+
+//------------------------------ tempLess -----------------------------------
+// Orders edges by from node, then to node, then distance
+static bool tempLess(const TempEdge& a, const TempEdge& b) {
+   if (a.from != b.from) return a.from < b.from;
+   if (a.to != b.to) return a.to < b.to;
+   return a.dist < b.dist;
+}
+
+//------------------------------ headLater ----------------------------------
+// Orders run heads so the heap's front is the smallest edge, ties going
+// to the earlier run
+static bool headLater(const RunHead& a, const RunHead& b) {
+   if (tempLess(a.edge, b.edge)) return false;
+   if (tempLess(b.edge, a.edge)) return true;
+   return a.run > b.run;
+}
+
+//------------------------------ runName ------------------------------------
+// Returns the name of the given run file made while building an edge file
+static string runName(const string& filename, int run) {
+   ostringstream name;
+   name << filename << ".run" << run << ".tmp";
+   return name.str();
+}
+//--------------------------- Constructor ---------------------------------
+// Default constructor for class GraphExternal
+// Preconditions:   none
+// Postconditions:  no edge file is open, size is 0, stats are 0
+GraphExternal::GraphExternal() {
+   base = NULL;
+   length = 0;
+   size = 0;
+   edgeCount = 0;
+   firstEdge = NULL;
+   edges = NULL;
+   pageSize = (size_t)sysconf(_SC_PAGESIZE);
+   resetStats();
+}
+
+//---------------------------- Destructor ---------------------------------
+// Destructor for class GraphExternal
+// Preconditions:   none
+// Postconditions:  the edge file, if any, is released
+GraphExternal::~GraphExternal() {
+   close();
+}
+
+//---------------------------- buildEdgeFile ------------------------------
+// Writes an edge file from edge lines, same format as the edges in
+// GraphM::buildGraph, that end with 0 0 0 or end of file:
+//       1 2 50               //[node1] [node2] [distance]
+//       1 3 20
+//       0 0 0
+// Edges are sorted in runs of at most the given number of bytes, which
+// are then merged, so memory use stays within the budget however many
+// edges a node has. Returns false if the file could not be
+// written or an edge line is bad (node not in the graph, negative
+// distance)
+// Preconditions:   the int is the number of nodes in the graph
+// Postconditions:  if true, the edge file holds every edge
+bool GraphExternal::buildEdgeFile(istream& infile, int nodeCount,
+                                  const string& filename, size_t budget) {
+   if (nodeCount < 0) return false;
+
+   //first pass: read the edges into runs that fit in the budget, count
+   //them per node, and write each full run, sorted, to its own file
+   size_t runEdges = max(budget / sizeof(TempEdge), (size_t)1);
+   vector<uint64_t> start(nodeCount + 2, 0);
+   vector<TempEdge> run;
+   vector<string> runs;                 //run files not merged yet
+   int made = 0;                        //run files made, for their names
+   bool ok = true;
+
+   int fromNode, toNode, distance;
+   while (ok && infile >> fromNode >> toNode >> distance) {
+      if (fromNode == 0 && toNode == 0)         //end of edge data
+         break;
+      if (   (fromNode > nodeCount || toNode > nodeCount) //not in graph
+          || (fromNode < 1         || toNode < 1)         //not in graph
+          || (distance < 0)                    //no negative distance
+         ) {
+         ok = false;
+         break;
+      }
+
+      if (run.size() == runEdges) {            //run is full, spill it
+         runs.push_back(runName(filename, made++));
+         ofstream runFile(runs.back().c_str(), ios::binary | ios::trunc);
+         ok = writeRun(run, runFile, false);
+         run.clear();
+      }
+      if (run.size() == run.capacity())        //grow, but not past budget
+         run.reserve(min(max(2 * run.size(), (size_t)BLOCK), runEdges));
+      TempEdge edge = { fromNode, toNode, distance };
+      run.push_back(edge);
+      start[fromNode + 1]++;
+   }
+   if (ok && !runs.empty() && !run.empty()) {
+      runs.push_back(runName(filename, made++));
+      ofstream runFile(runs.back().c_str(), ios::binary | ios::trunc);
+      ok = writeRun(run, runFile, false);
+      run.clear();
+   }
+
+   //too many runs to open at once: merge the oldest into one bigger run
+   while (ok && (int)runs.size() > MAXRUNS) {
+      vector<string> group(runs.begin(), runs.begin() + MAXRUNS);
+      runs.push_back(runName(filename, made++));
+      ofstream runFile(runs.back().c_str(), ios::binary | ios::trunc);
+      ok = mergeRuns(group, runFile, budget, false);
+      for (int i = 0; ok && i < MAXRUNS; i++)
+         remove(group[i].c_str());
+      if (ok) runs.erase(runs.begin(), runs.begin() + MAXRUNS);
+   }
+
+   //start[v] becomes the index of the first edge of v
+   for (int v = 1; v <= nodeCount; v++)
+      start[v + 1] += start[v];
+   uint64_t total = start[nodeCount + 1];
+
+   ExternalHeader header;
+   memset(&header, 0, sizeof(header));
+   strncpy(header.magic, "DJKCSR", sizeof(header.magic));
+   header.version = EXTERNAL_VERSION;
+   header.size = nodeCount;
+   header.edgeCount = total;
+   header.indexOffset = sizeof(header);
+   header.edgeOffset = header.indexOffset + start.size() * sizeof(uint64_t);
+   header.fileSize = header.edgeOffset + total * sizeof(ExternalEdge);
+
+   //second pass: merge the runs into the edge file, front to back. If
+   //every edge fit in one run it is still in memory, no merge needed
+   string outName = filename + ".tmp";
+   ofstream outfile;
+   if (ok) {
+      outfile.open(outName.c_str(), ios::binary | ios::trunc);
+      outfile.write((const char*)&header, sizeof(header));
+      outfile.write((const char*)&start[0], start.size() * sizeof(uint64_t));
+      if (runs.empty())
+         ok = writeRun(run, outfile, true);
+      else
+         ok = mergeRuns(runs, outfile, budget, true);
+      outfile.close();
+   }
+
+   for (int i = 0; i < (int)runs.size(); i++)
+      remove(runs[i].c_str());
+   if (!ok || !outfile || rename(outName.c_str(), filename.c_str()) != 0) {
+      remove(outName.c_str());
+      return false;
+   }
+   return true;
+}
+
+//------------------------------- open ------------------------------------
+// Maps an edge file made by buildEdgeFile, returns true if the file is a
+// valid edge file
+// Preconditions:   none
+// Postconditions:  if true, queries read edges from the file. if false,
+//       no file is open
+bool GraphExternal::open(const string& filename) {
+   close();
+
+   int fd = ::open(filename.c_str(), O_RDONLY);
+   if (fd < 0) return false;
+
+   struct stat info;
+   if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(ExternalHeader)) {
+      ::close(fd);
+      return false;
+   }
+
+   void* map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+   ::close(fd);               // the mapping keeps the file alive
+   if (map == MAP_FAILED) return false;
+
+   base = (const char*)map;
+   length = info.st_size;
+
+   //check the header before trusting any offset in it
+   const ExternalHeader* header = (const ExternalHeader*)base;
+   uint64_t indexCount = header->size >= 0 ? (uint64_t)header->size + 2 : 0;
+   if (   strncmp(header->magic, "DJKCSR", sizeof(header->magic)) != 0
+       || header->version != EXTERNAL_VERSION   //written by other version
+       || header->size < 0
+       || header->fileSize != length            //truncated or appended to
+       || header->indexOffset + indexCount * sizeof(uint64_t) > length
+       || header->edgeOffset
+             + header->edgeCount * sizeof(ExternalEdge) > length
+      ) {
+      close();
+      return false;
+   }
+
+   firstEdge = (const uint64_t*)(base + header->indexOffset);
+   edges = (const ExternalEdge*)(base + header->edgeOffset);
+
+   //every node's edges must be in order and inside the file
+   for (int v = 1; v <= header->size; v++) {
+      if (   firstEdge[v] > firstEdge[v + 1]
+          || firstEdge[v + 1] > header->edgeCount) {
+         close();
+         return false;
+      }
+   }
+
+   size = header->size;
+   edgeCount = header->edgeCount;
+
+   //edges are read in the order nodes are settled, not file order, so
+   //read ahead only wastes I/O. prefetch does the reading ahead instead
+   size_t edgeStart = header->edgeOffset & ~(pageSize - 1);
+   madvise((void*)(base + edgeStart), length - edgeStart, MADV_RANDOM);
+   return true;
+}
+
+//------------------------------- close -----------------------------------
+// Releases the edge file
+// Preconditions:   none
+// Postconditions:  no file is open and size is 0
+void GraphExternal::close() {
+   if (base != NULL)
+      munmap((void*)base, length);
+   base = NULL;
+   length = 0;
+   size = 0;
+   edgeCount = 0;
+   firstEdge = NULL;
+   edges = NULL;
+}
+
+//------------------------------ getSize ----------------------------------
+// Returns the number of nodes in the open edge file, 0 if none
+// Preconditions:   none
+// Postconditions:  none
+int GraphExternal::getSize() const {
+   return size;
+}
+
+//---------------------------- getEdgeCount -------------------------------
+// Returns the number of edges in the open edge file, 0 if none
+// Preconditions:   none
+// Postconditions:  none
+long long GraphExternal::getEdgeCount() const {
+   return (long long)edgeCount;
+}
+
+//-------------------------- findShortestPath -----------------------------
+// Finds the shortest path from the source to every node. dist[i] is the
+// shortest distance to node i (INT_MAX if no path) and path[i] is the
+// previous node on that path (0 for the source or if no path). Returns
+// the number of nodes that can be reached, the source included
+// Preconditions:   an edge file is open
+// Postconditions:  dist and path hold size + 1 entries, index 0 unused
+int GraphExternal::findShortestPath(int source, vector<int>& dist,
+                                    vector<int>& path) {
+   dist.assign(size + 1, INT_MAX);
+   path.assign(size + 1, 0);
+   if (source > size || source < 1) return 0;  //source not in the graph
+
+   stats.queries++;
+   struct rusage before;
+   getrusage(FAULT_WHO, &before);
+
+   vector<bool> visited(size + 1, false);
+   vector<pair<int, int> > heap;     //(dist, node) min heap
+   greater<pair<int, int> > later;
+   int reached = 0;
+
+   dist[source] = 0;
+   heap.push_back(make_pair(0, source));
+
+   while (!heap.empty()) {
+      //take the closest node not visited yet
+      pop_heap(heap.begin(), heap.end(), later);
+      int d = heap.back().first;
+      int v = heap.back().second;
+      heap.pop_back();
+      if (visited[v]) continue;        //older, longer entry for v
+
+      visited[v] = true;
+      reached++;
+      stats.nodesSettled++;
+
+      //the closest node left is the most likely to be settled next
+      if (!heap.empty())
+         prefetch(heap.front().second);
+
+      uint64_t begin = firstEdge[v], end = firstEdge[v + 1];
+      if (begin < end) {
+         size_t firstByte = (const char*)&edges[begin] - base;
+         size_t lastByte = (const char*)&edges[end] - base - 1;
+         stats.edgesScanned += end - begin;
+         stats.bytesScanned += (end - begin) * sizeof(ExternalEdge);
+         stats.pagesTouched += lastByte / pageSize - firstByte / pageSize + 1;
+      }
+
+      //for each adjacent node not visited
+      for (uint64_t e = begin; e < end; e++) {
+         int w = edges[e].to;
+         int cost = edges[e].dist;
+         if (w < 1 || w > size || visited[w] || cost < 0) continue;
+         if (cost > INT_MAX - 1 - d) continue;  //would overflow "infinity"
+
+         //if going through v is better
+         if (d + cost < dist[w]) {
+            dist[w] = d + cost;
+            path[w] = v;
+            heap.push_back(make_pair(dist[w], w));
+            push_heap(heap.begin(), heap.end(), later);
+         }
+      }
+   }
+
+   struct rusage after;
+   getrusage(FAULT_WHO, &after);
+   stats.majorFaults += after.ru_majflt - before.ru_majflt;
+   return reached;
+}
+
+//------------------------------ getStats ---------------------------------
+// Returns the I/O done by queries since the last resetStats
+// Preconditions:   none
+// Postconditions:  none
+ExternalStats GraphExternal::getStats() const {
+   return stats;
+}
+
+//----------------------------- resetStats --------------------------------
+// Sets every I/O counter back to 0
+// Preconditions:   none
+// Postconditions:  getStats returns all 0
+void GraphExternal::resetStats() {
+   memset(&stats, 0, sizeof(stats));
+}
+
+//------------------------------ prefetch ---------------------------------
+// Helper for findShortestPath. Asks the kernel to start reading the edges
+// of a node, so they are in memory by the time the node is settled
+// Preconditions:   an edge file is open
+// Postconditions:  none
+void GraphExternal::prefetch(int node) {
+   uint64_t begin = firstEdge[node], end = firstEdge[node + 1];
+   if (begin == end) return;          //no edges to read
+
+   size_t firstByte = (const char*)&edges[begin] - base;
+   size_t lastByte = (const char*)&edges[end] - base;
+   size_t pageStart = firstByte & ~(pageSize - 1);
+   madvise((void*)(base + pageStart), lastByte - pageStart, MADV_WILLNEED);
+   stats.prefetches++;
+}
+
+//------------------------------- writeRun --------------------------------
+// Helper for buildEdgeFile. Sorts the edges by from node, to node and
+// distance and writes them to the stream, as TempEdges if the bool is
+// false or as ExternalEdges (from node left out) if true
+// Preconditions:   none
+// Postconditions:  the edges are sorted, returns false if a write failed
+bool GraphExternal::writeRun(vector<TempEdge>& run, ostream& outfile,
+                             bool final) {
+   sort(run.begin(), run.end(), tempLess);
+   if (!run.empty())
+      writeEdges(outfile, &run[0], run.size(), final);
+   return (bool)outfile;
+}
+
+//------------------------------ mergeRuns --------------------------------
+// Helper for buildEdgeFile. Merges run files made by writeRun into one
+// sorted stream of edges, written as for writeRun. Each run is read
+// through its own buffer, and the buffers together with the output
+// buffer hold at most the given number of bytes
+// Preconditions:   each file holds TempEdges sorted by from node, to
+//          node and distance
+// Postconditions:  returns false if a read or write failed
+bool GraphExternal::mergeRuns(const vector<string>& names, ostream& outfile,
+                              size_t budget, bool final) {
+   int count = (int)names.size();
+   size_t bufferEdges = max(budget / sizeof(TempEdge) / (count + 1),
+                            (size_t)1);
+   vector<ifstream> files(count);
+   vector<vector<TempEdge> > buffer(count, vector<TempEdge>(bufferEdges));
+   vector<size_t> next(count, 0), filled(count, 0);
+   vector<RunHead> heap;                //first unmerged edge of each run
+   vector<TempEdge> output;
+   output.reserve(bufferEdges);
+
+   //fill every buffer and put the first edge of each run on the heap
+   for (int i = 0; i < count; i++) {
+      files[i].open(names[i].c_str(), ios::binary);
+      if (!files[i]) return false;
+      files[i].read((char*)&buffer[i][0], bufferEdges * sizeof(TempEdge));
+      filled[i] = files[i].gcount() / sizeof(TempEdge);
+      if (filled[i] > 0) {
+         RunHead head = { buffer[i][0], i };
+         heap.push_back(head);
+      }
+   }
+   make_heap(heap.begin(), heap.end(), headLater);
+
+   while (!heap.empty()) {
+      //take the smallest edge left in any run
+      pop_heap(heap.begin(), heap.end(), headLater);
+      int i = heap.back().run;
+      output.push_back(heap.back().edge);
+      heap.pop_back();
+      if (output.size() == bufferEdges) {
+         writeEdges(outfile, &output[0], output.size(), final);
+         output.clear();
+      }
+
+      //refill run i's buffer once it is used up
+      if (++next[i] == filled[i]) {
+         files[i].read((char*)&buffer[i][0], bufferEdges * sizeof(TempEdge));
+         filled[i] = files[i].gcount() / sizeof(TempEdge);
+         next[i] = 0;
+      }
+      if (next[i] < filled[i]) {
+         RunHead head = { buffer[i][next[i]], i };
+         heap.push_back(head);
+         push_heap(heap.begin(), heap.end(), headLater);
+      }
+   }
+   if (!output.empty())
+      writeEdges(outfile, &output[0], output.size(), final);
+
+   for (int i = 0; i < count; i++)
+      if (files[i].bad()) return false;
+   return (bool)outfile;
+}
+
+//------------------------------ writeEdges -------------------------------
+// Helper for writeRun and mergeRuns. Writes the edges to the stream as
+// TempEdges if the bool is false or as ExternalEdges if true
+// Preconditions:   none
+// Postconditions:  none, the stream fails if a write failed
+void GraphExternal::writeEdges(ostream& outfile, const TempEdge* edge,
+                               size_t count, bool final) {
+   if (!final) {
+      outfile.write((const char*)edge, count * sizeof(TempEdge));
+      return;
+   }
+
+   //drop the from node, a block at a time
+   vector<ExternalEdge> block(min(count, (size_t)BLOCK));
+   while (count > 0 && outfile) {
+      size_t part = min(count, block.size());
+      for (size_t i = 0; i < part; i++) {
+         block[i].to = edge[i].to;
+         block[i].dist = edge[i].dist;
+      }
+      outfile.write((const char*)&block[0], part * sizeof(ExternalEdge));
+      edge += part;
+      count -= part;
+   }
+}
@@ -0,0 +1,203 @@
+//-----------------------------------------------------------------------//
+// GRAPHEXTERNAL.H                                                       //
+//                                                                       //
+// GraphExternal runs Dijkstra's shortest path algorithm on graphs whose //
+// edges do not fit in memory.  Edges stay in a file on disk, only the   //
+// distance, path and heap of each node are kept in memory               //
+//-----------------------------------------------------------------------//
+// Edge file: a compressed sparse row (CSR) file made by buildEdgeFile.  //
+//        It holds a header, the index of the first edge of each node,   //
+//        then every edge as [to node] [distance], grouped by from node  //
+//        and sorted by to node.  The file is memory mapped and the      //
+//        edges of a node are read in place when the node is settled.    //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- node numbers start at 1, like GraphM and GraphL                 //
+//    -- does not accept negative distances                              //
+//    -- repeated edges between two nodes are all kept, the shortest one //
+//       is the one a path uses                                          //
+//    -- the edge file is read on a machine with the same byte order and //
+//       int size as the machine that wrote it                           //
+//    -- the kernel is told not to read ahead in the edges, instead the  //
+//       edges of the next node to be settled are prefetched             //
+//    -- buildEdgeFile writes sorted runs that fit in its memory budget  //
+//       to temporary files beside the edge file, then merges them       //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#ifndef GRAPHEXTERNAL_H
+#define GRAPHEXTERNAL_H
+#include <iostream>
+#include <string>
+#include <vector>
+#include <limits.h>
+#include <stdint.h>
+using namespace std;
+
+// on-disk layout of the start of an edge file, offsets are in bytes from
+// the start of the file
+struct ExternalHeader {
+   char magic[8];            // "DJKCSR" and terminating '\0's
+   uint32_t version;         // EXTERNAL_VERSION of the writer
+   int32_t size;             // number of nodes in the graph
+   uint64_t edgeCount;       // number of edges in the graph
+   uint64_t indexOffset;     // uint64 first edge of each node, size + 2
+   uint64_t edgeOffset;      // ExternalEdge array, edgeCount long
+   uint64_t fileSize;        // total bytes in the file
+};
+
+// one edge in the edge file, the from node is implied by its position
+struct ExternalEdge {
+   int32_t to;               // node the edge points to
+   int32_t dist;             // distance of the edge
+};
+
+// one edge in a run file, the sorted pieces buildEdgeFile merges
+struct TempEdge {
+   int32_t from;             // node the edge leaves
+   int32_t to;               // node the edge points to
+   int32_t dist;             // distance of the edge
+};
+
+const uint32_t EXTERNAL_VERSION = 1;
+
+// I/O done by queries since the last resetStats
+struct ExternalStats {
+   long long queries;        // findShortestPath calls
+   long long nodesSettled;   // nodes whose edges were read
+   long long edgesScanned;   // edges read from the file
+   long long bytesScanned;   // bytes of edges read from the file
+   long long pagesTouched;   // file pages the edge reads fell on
+   long long prefetches;     // edge ranges asked for ahead of time
+   long long majorFaults;    // page faults that had to go to disk
+};
+
+class GraphExternal {
+
+public:
+//--------------------------- Constructor ---------------------------------
+// Default constructor for class GraphExternal
+// Preconditions:   none
+// Postconditions:  no edge file is open, size is 0, stats are 0
+GraphExternal();
+
+//---------------------------- Destructor ---------------------------------
+// Destructor for class GraphExternal
+// Preconditions:   none
+// Postconditions:  the edge file, if any, is released
+~GraphExternal();
+
+//---------------------------- buildEdgeFile ------------------------------
+// Writes an edge file from edge lines, same format as the edges in
+// GraphM::buildGraph, that end with 0 0 0 or end of file:
+//       1 2 50               //[node1] [node2] [distance]
+//       1 3 20
+//       0 0 0
+// Edges are sorted in runs of at most the given number of bytes, which
+// are then merged, so memory use stays within the budget however many
+// edges a node has. Returns false if the file could not be
+// written or an edge line is bad (node not in the graph, negative
+// distance)
+// Preconditions:   the int is the number of nodes in the graph
+// Postconditions:  if true, the edge file holds every edge
+static bool buildEdgeFile(istream&, int, const string&, size_t);
+
+//------------------------------- open ------------------------------------
+// Maps an edge file made by buildEdgeFile, returns true if the file is a
+// valid edge file
+// Preconditions:   none
+// Postconditions:  if true, queries read edges from the file. if false,
+//       no file is open
+bool open(const string&);
+
+//------------------------------- close -----------------------------------
+// Releases the edge file
+// Preconditions:   none
+// Postconditions:  no file is open and size is 0
+void close();
+
+//------------------------------ getSize ----------------------------------
+// Returns the number of nodes in the open edge file, 0 if none
+// Preconditions:   none
+// Postconditions:  none
+int getSize() const;
+
+//---------------------------- getEdgeCount -------------------------------
+// Returns the number of edges in the open edge file, 0 if none
+// Preconditions:   none
+// Postconditions:  none
+long long getEdgeCount() const;
+
+//-------------------------- findShortestPath -----------------------------
+// Finds the shortest path from the source to every node. dist[i] is the
+// shortest distance to node i (INT_MAX if no path) and path[i] is the
+// previous node on that path (0 for the source or if no path). Returns
+// the number of nodes that can be reached, the source included
+// Preconditions:   an edge file is open
+// Postconditions:  dist and path hold size + 1 entries, index 0 unused
+int findShortestPath(int, vector<int>&, vector<int>&);
+
+//------------------------------ getStats ---------------------------------
+// Returns the I/O done by queries since the last resetStats
+// Preconditions:   none
+// Postconditions:  none
+ExternalStats getStats() const;
+
+//----------------------------- resetStats --------------------------------
+// Sets every I/O counter back to 0
+// Preconditions:   none
+// Postconditions:  getStats returns all 0
+void resetStats();
+
+private:
+
+   const char* base;              // start of the mapped file
+   size_t length;                 // bytes mapped
+   int size;                      // number of nodes in the graph
+   uint64_t edgeCount;            // number of edges in the graph
+   const uint64_t* firstEdge;     // index of the first edge of each node
+   const ExternalEdge* edges;     // every edge, grouped by from node
+   size_t pageSize;               // bytes in one memory page
+   ExternalStats stats;           // I/O since the last resetStats
+
+   static const int MAXRUNS = 64;       // most run files merged at once
+   static const int BLOCK = 4096;       // edges converted per write
+
+   GraphExternal(const GraphExternal&);            // not copyable
+   GraphExternal& operator=(const GraphExternal&);
+
+//------------------------------ prefetch ---------------------------------
+// Helper for findShortestPath. Asks the kernel to start reading the edges
+// of a node, so they are in memory by the time the node is settled
+// Preconditions:   an edge file is open
+// Postconditions:  none
+void prefetch(int);
+
+//------------------------------- writeRun --------------------------------
+// Helper for buildEdgeFile. Sorts the edges by from node, to node and
+// distance and writes them to the stream, as TempEdges if the bool is
+// false or as ExternalEdges (from node left out) if true
+// Preconditions:   none
+// Postconditions:  the edges are sorted, returns false if a write failed
+static bool writeRun(vector<TempEdge>&, ostream&, bool);
+
+//------------------------------ mergeRuns --------------------------------
+// Helper for buildEdgeFile. Merges run files made by writeRun into one
+// sorted stream of edges, written as for writeRun. Each run is read
+// through its own buffer, and the buffers together with the output
+// buffer hold at most the given number of bytes
+// Preconditions:   each file holds TempEdges sorted by from node, to
+//          node and distance
+// Postconditions:  returns false if a read or write failed
+static bool mergeRuns(const vector<string>&, ostream&, size_t, bool);
+
+//------------------------------ writeEdges -------------------------------
+// Helper for writeRun and mergeRuns. Writes the edges to the stream as
+// TempEdges if the bool is false or as ExternalEdges if true
+// Preconditions:   none
+// Postconditions:  none, the stream fails if a write failed
+static void writeEdges(ostream&, const TempEdge*, size_t, bool);
+
+};
+
+#endif
@@ -28,6 +28,7 @@
 //          size is 0
 GraphL::GraphL() {
    size = 0;
+   edgeBlock = NULL;
    for (int i = 0; i < MAXNODES; i++)
       adjList[i].edgeHead = NULL;
 }
@@ -46,9 +47,16 @@ GraphL::~GraphL() {
 // Preconditions:   none
 // Postconditions:  all data is set to construction values
 void GraphL::makeEmpty() {
+   if (edgeBlock != NULL) {      //edges made by buildEdges, one block
+      delete[] edgeBlock;
+      edgeBlock = NULL;
+   } else {
+      for (int i = 0; i <= size; i++)
+         if (adjList[i].edgeHead != NULL)
+            clearEdgeNodeList(adjList[i].edgeHead);
+   }
    for (int i = 0; i <= size; i++)
-      if (adjList[i].edgeHead != NULL)
-         clearEdgeNodeList(adjList[i].edgeHead);
+      adjList[i].edgeHead = NULL;
    size = 0;
 }
 
@@ -81,22 +89,8 @@ void GraphL::clearEdgeNodeList(EdgeNode* cur) {
 // Postconditions:  nodes and edges are inputted into GraphL
 void GraphL::buildGraph(istream& infile) {
    int fromNode, toNode;      // from and to node ends of edge
-   int distance;              // distance between the nodes
 
-   makeEmpty();               // clear the graph of memory 
-
-   infile >> size;            // read the number of nodes
-   if (infile.eof()) return;  // stop if no more data
-   
-   string s;                  // used to read through to end of line
-   getline(infile, s);
-
-   // read graph node information
-   for (int i = 1; i <= size; i++) {
-      adjList[i].data.setData(infile);
-      adjList[i].edgeHead = NULL;
-      adjList[i].visited = false;
-   }
+   if (!buildNodes(infile)) return;  // stop if no more data
 
    // read the edge data and add to the adjacency list
    for (;;) {
@@ -121,6 +115,74 @@ void GraphL::buildGraph(istream& infile) {
    }
 }
 
+//----------------------------- buildEdges --------------------------------
+// Replaces every edge of GraphL with the edges in the array, returns the
+// number of edges stored. Invalid edges (see bulkedges.h) are skipped and
+// an edge that appears more than once is stored once. All edge nodes are
+// made in one block, and each edge list is in order of to node
+// Preconditions: the nodes are already in GraphL (see buildGraph)
+// Postconditions: GraphL holds exactly the valid edges of the array
+int GraphL::buildEdges(const EdgeTriple* edges, int count) {
+   vector<EdgeTriple> sorted;
+   vector<int> first;
+   sortEdges(edges, count, size, KEEP_LAST, sorted, first);
+
+   //clear the old edges, but keep the nodes
+   int nodes = size;
+   makeEmpty();
+   size = nodes;
+   if (sorted.empty()) return 0;
+
+   //link each node's edges inside the block, in sorted order
+   edgeBlock = new EdgeNode[sorted.size()];
+   for (int i = 1; i <= size; i++) {
+      if (first[i] == first[i + 1]) continue;     //no edges
+      adjList[i].edgeHead = &edgeBlock[first[i]];
+      for (int e = first[i]; e < first[i + 1]; e++) {
+         edgeBlock[e].adjGraphNode = sorted[e].to;
+         edgeBlock[e].nextEdge = e + 1 < first[i + 1] ? &edgeBlock[e + 1]
+                                                      : NULL;
+      }
+   }
+   return (int)sorted.size();
+}
+
+//----------------------------- buildNodes --------------------------------
+// Reads the number of nodes and the node names, the first part of the
+// buildGraph input, and leaves the edges unread. Returns false if there
+// was no more data, or the number of nodes is negative or more than
+// getMaxSize
+// Preconditions:   none
+// Assumptions: node names are less than 51 characters in length
+// Postconditions:  GraphL is emptied and holds the nodes, with no edges
+bool GraphL::buildNodes(istream& infile) {
+   makeEmpty();               // clear the graph of memory 
+
+   int nodes = 0;
+   infile >> nodes;           // read the number of nodes
+   if (infile.eof()) return false;  // stop if no more data
+   if (nodes < 0 || nodes > getMaxSize()) return false;  // does not fit
+   
+   string s;                  // used to read through to end of line
+   getline(infile, s);
+
+   // read graph node information
+   size = nodes;
+   for (int i = 1; i <= size; i++) {
+      adjList[i].data.setData(infile);
+      adjList[i].edgeHead = NULL;
+   }
+   return true;
+}
+
+//----------------------------- getMaxSize --------------------------------
+// Returns the most nodes GraphL can hold
+// Preconditions:   none
+// Postconditions:  none
+int GraphL::getMaxSize() {
+   return MAXNODES - 1;       // index 0 is not used
+}
+
 //------------------------------ displayGraph -----------------------------
 // Displays through cout all of the nodes and edges inbetween them.
 // Extra blank line included, because lab3.cpp doesn't have one..
@@ -148,43 +210,145 @@ void GraphL::displayGraph() const{
 // greatest. Extra blank line included, because lab3.cpp doesn't have one..
 // Assumptions: source is node 1
 // Preconditions: none
-// Postconditions: none
-void GraphL::depthFirstSearch() {
-   //print and mark each graph node in adjList[i]'s edge list
+// Postconditions: none, the graph is not changed
+void GraphL::depthFirstSearch() const {
+   vector<int> order;
+   depthFirstOrder(order);
+
    cout << "Depth First Search: ";
-   for (int i = 1; i <= size; i++)
-      depthFirstSearchHelper(i);
+   for (size_t i = 0; i < order.size(); i++)
+      cout << order[i] << " ";
    cout << endl << endl; //extra blank line
+}
+
+//--------------------------- depthFirstOrder -----------------------------
+// Fills the vector with all of the nodes in depth first order, the same
+// order depthFirstSearch displays, and returns the number of nodes. The
+// visited marks are kept in the workspace, so many threads can search
+// the same graph at once. With a QueryControl the search stops early,
+// and the vector holds the nodes visited so far, if it is stopped
+// Assumptions: source is node 1
+// Preconditions: none
+// Postconditions: none, the graph is not changed
+int GraphL::depthFirstOrder(vector<int>& order) const {
+   return depthFirstOrder(order, QueryWorkspace::local());
+}
 
-   //reset visit values so you can call this method again if you want
+int GraphL::depthFirstOrder(vector<int>& order, QueryWorkspace& work) const {
+   order.clear();
+   work.begin(size);
+
+   //add and mark each graph node in adjList[i]'s edge list
    for (int i = 1; i <= size; i++)
-      adjList[i].visited = false;
+      if (work.done[i] != work.epoch)
+         depthFirstSearchHelper(i, order, work, NULL);
+   return (int)order.size();
 }
 
-//------------------------- depthFirstSearchHelper ------------------------
-// Helper for depthFirstSearch. Displays through cout all of the nodes in
-// order of depth, least to greatest. Trailing endl included
+int GraphL::depthFirstOrder(vector<int>& order, QueryWorkspace& work,
+                            QueryControl& control) const {
+   order.clear();
+   work.begin(size);
+
+   for (int i = 1; i <= size && !control.poll(); i++)
+      if (work.done[i] != work.epoch)
+         depthFirstSearchHelper(i, order, work, &control);
+   return (int)order.size();
+}
+
+//-------------------------- breadthFirstSearch ---------------------------
+// Displays through cout all of the nodes in breadth first order, each
+// node's edges in list order. Extra blank line included, like
+// depthFirstSearch
+// Assumptions: source is node 1
 // Preconditions: none
-// Postconditions: none
-void GraphL::depthFirstSearchHelper(int nodeIndex) {
-   //print and mark visited if not visited
-   if (!adjList[nodeIndex].visited) {
-      adjList[nodeIndex].visited = true;
-      cout << nodeIndex << " ";
+// Postconditions: none, the graph is not changed
+void GraphL::breadthFirstSearch() const {
+   vector<int> order;
+   breadthFirstOrder(order);
+
+   cout << "Breadth First Search: ";
+   for (size_t i = 0; i < order.size(); i++)
+      cout << order[i] << " ";
+   cout << endl << endl; //extra blank line
+}
+
+//--------------------------- breadthFirstOrder ---------------------------
+// Fills the vector with all of the nodes in breadth first order, the same
+// order breadthFirstSearch displays, and returns the number of nodes.
+// Nodes not reached from node 1 start a new search, in node order. With a
+// QueryControl the search stops early, and the vector holds the nodes
+// visited so far, if it is stopped
+// Assumptions: source is node 1
+// Preconditions: none
+// Postconditions: none, the graph is not changed
+int GraphL::breadthFirstOrder(vector<int>& order) const {
+   return breadthFirstOrder(order, QueryWorkspace::local());
+}
+
+int GraphL::breadthFirstOrder(vector<int>& order, QueryWorkspace& work) const {
+   QueryControl control;            //never cancelled, no deadline
+   return breadthFirstOrder(order, work, control);
+}
+
+int GraphL::breadthFirstOrder(vector<int>& order, QueryWorkspace& work,
+                              QueryControl& control) const {
+   order.clear();
+   work.begin(size);
+
+   //order is also the queue, next is the node to visit next
+   size_t next = 0;
+   for (int i = 1; i <= size; i++) {
+      if (work.done[i] == work.epoch) continue;
+      work.done[i] = work.epoch;
+      order.push_back(i);
+
+      while (next < order.size()) {
+         if (control.poll()) return (int)order.size();  //stopped by caller
+
+         //add every edge node not added yet, in list order
+         EdgeNode* cur = adjList[order[next++]].edgeHead;
+         for (; cur != NULL; cur = cur->nextEdge) {
+            if (work.done[cur->adjGraphNode] != work.epoch) {
+               work.done[cur->adjGraphNode] = work.epoch;
+               order.push_back(cur->adjGraphNode);
+            }
+         }
+      }
+   }
+   return (int)order.size();
+}
+
+//------------------------- depthFirstSearchHelper ------------------------
+// Helper for depthFirstOrder. Adds to the vector all of the nodes not yet
+// visited in order of depth, least to greatest, from the node given. The
+// control, if not NULL, is polled once for every call
+// Preconditions: the workspace was started for this search
+// Postconditions: every node added is marked done in the workspace
+void GraphL::depthFirstSearchHelper(int nodeIndex, vector<int>& order,
+                                    QueryWorkspace& work,
+                                    QueryControl* control) const {
+   if (control != NULL && control->poll()) return;  //stopped by caller
+
+   //add and mark visited if not visited
+   if (work.done[nodeIndex] != work.epoch) {
+      work.done[nodeIndex] = work.epoch;
+      order.push_back(nodeIndex);
    }
 
    if (adjList[nodeIndex].edgeHead != NULL) { //if nodeIndex has edges
       EdgeNode* cur = adjList[nodeIndex].edgeHead;
 
       //go to first edge node down in depth
-      if (!adjList[cur->adjGraphNode].visited)
-         depthFirstSearchHelper(cur->adjGraphNode);
+      if (work.done[cur->adjGraphNode] != work.epoch)
+         depthFirstSearchHelper(cur->adjGraphNode, order, work, control);
       
       //then display other edge nodes of nodeIndex
       while (cur->nextEdge != NULL) {
          cur = cur->nextEdge;
-         if (!adjList[cur->adjGraphNode].visited)
-            depthFirstSearchHelper( cur->adjGraphNode);
+         if (work.done[cur->adjGraphNode] != work.epoch)
+            depthFirstSearchHelper(cur->adjGraphNode, order, work,
+                                   control);
       }
    }
 }
@@ -24,7 +24,11 @@
 #include <iostream>
 #include <iomanip>
 #include <limits.h>
+#include <vector>
 #include "nodedata.h"
+#include "bulkedges.h"
+#include "queryworkspace.h"
+#include "querycontrol.h"
 using namespace std;
 
 struct EdgeNode { 
@@ -36,7 +40,6 @@ struct GraphNode { // structs used for simplicity, use classes if desired
    //name of node
    NodeData data;      //not a pointer because I don't want to deal with it
    EdgeNode* edgeHead; // head of the list of edges 
-   bool visited;
 }; 
 
 class GraphL {
@@ -78,6 +81,31 @@ void makeEmpty();
 // Postconditions:  nodes and edges are inputted into GraphL
 void buildGraph(istream&);
 
+//----------------------------- buildNodes --------------------------------
+// Reads the number of nodes and the node names, the first part of the
+// buildGraph input, and leaves the edges unread. Returns false if there
+// was no more data, or the number of nodes is negative or more than
+// getMaxSize
+// Preconditions:   none
+// Assumptions: node names are less than 51 characters in length
+// Postconditions:  GraphL is emptied and holds the nodes, with no edges
+bool buildNodes(istream&);
+
+//----------------------------- getMaxSize --------------------------------
+// Returns the most nodes GraphL can hold
+// Preconditions:   none
+// Postconditions:  none
+static int getMaxSize();
+
+//----------------------------- buildEdges --------------------------------
+// Replaces every edge of GraphL with the edges in the array, returns the
+// number of edges stored. Invalid edges (see bulkedges.h) are skipped and
+// an edge that appears more than once is stored once. All edge nodes are
+// made in one block, and each edge list is in order of to node
+// Preconditions: the nodes are already in GraphL (see buildGraph)
+// Postconditions: GraphL holds exactly the valid edges of the array
+int buildEdges(const EdgeTriple*, int);
+
 //------------------------------ displayGraph -----------------------------
 // Displays through cout all of the nodes and edges inbetween them.
 // Extra blank line included, because lab3.cpp doesn't have one..
@@ -90,8 +118,43 @@ void displayGraph() const;
 // greatest. Extra blank line included, because lab3.cpp doesn't have one..
 // Assumptions: source is node 1
 // Preconditions: none
-// Postconditions: none
-void depthFirstSearch();
+// Postconditions: none, the graph is not changed
+void depthFirstSearch() const;
+
+//--------------------------- depthFirstOrder -----------------------------
+// Fills the vector with all of the nodes in depth first order, the same
+// order depthFirstSearch displays, and returns the number of nodes. The
+// visited marks are kept in the workspace, so many threads can search
+// the same graph at once. With a QueryControl the search stops early,
+// and the vector holds the nodes visited so far, if it is stopped
+// Assumptions: source is node 1
+// Preconditions: none
+// Postconditions: none, the graph is not changed
+int depthFirstOrder(vector<int>&) const;
+int depthFirstOrder(vector<int>&, QueryWorkspace&) const;
+int depthFirstOrder(vector<int>&, QueryWorkspace&, QueryControl&) const;
+
+//-------------------------- breadthFirstSearch ---------------------------
+// Displays through cout all of the nodes in breadth first order, each
+// node's edges in list order. Extra blank line included, like
+// depthFirstSearch
+// Assumptions: source is node 1
+// Preconditions: none
+// Postconditions: none, the graph is not changed
+void breadthFirstSearch() const;
+
+//--------------------------- breadthFirstOrder ---------------------------
+// Fills the vector with all of the nodes in breadth first order, the same
+// order breadthFirstSearch displays, and returns the number of nodes.
+// Nodes not reached from node 1 start a new search, in node order. With a
+// QueryControl the search stops early, and the vector holds the nodes
+// visited so far, if it is stopped
+// Assumptions: source is node 1
+// Preconditions: none
+// Postconditions: none, the graph is not changed
+int breadthFirstOrder(vector<int>&) const;
+int breadthFirstOrder(vector<int>&, QueryWorkspace&) const;
+int breadthFirstOrder(vector<int>&, QueryWorkspace&, QueryControl&) const;
 
 
 private: 
@@ -102,6 +165,8 @@ private:
    
    int size;   // number of nodes in the graph 
 
+   EdgeNode* edgeBlock; // all edge nodes if made by buildEdges, else NULL
+
 //-------------------------- clearEdgeNodeList ----------------------------
 // Helper for function makeEmpty. All objects in GraphL are deleted, and 
 // size is 0
@@ -110,11 +175,13 @@ private:
 void clearEdgeNodeList(EdgeNode*);
 
 //------------------------ depthFirstSearchHelper -------------------------
-// Helper for depthFirstSearch. Displays through cout all of the nodes in
-// order of depth, least to greatest. Trailing endl included
-// Preconditions: none
-// Postconditions: none
-void depthFirstSearchHelper(int);
+// Helper for depthFirstOrder. Adds to the vector all of the nodes not yet
+// visited in order of depth, least to greatest, from the node given. The
+// control, if not NULL, is polled once for every call
+// Preconditions: the workspace was started for this search
+// Postconditions: every node added is marked done in the workspace
+void depthFirstSearchHelper(int, vector<int>&, QueryWorkspace&,
+                            QueryControl*) const;
    
 };
 
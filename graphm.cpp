@@ -21,6 +21,14 @@
 //-----------------------------------------------------------------------//
 
 #include "graphm.h"
+#include "graphsnapshot.h"
+#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <map>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
 
 //-------------------------- Constructor ----------------------------------
 // Default constructor for class GraphM
@@ -28,14 +36,15 @@
 // Postconditions:  all array are initialized and size is 0
 GraphM::GraphM() {
    size = 0;
+   componentCount = 0;
    for (int i = 0; i < MAXNODES; i++) {
       for (int j = 0; j < MAXNODES; j++){
          C[i][j] = INT_MAX;         //set cost to "infinity"
 
          T[i][j].dist = INT_MAX;    //intitial distances are "infinity"
-         T[i][j].visited = false;
          T[i][j].path = 0;
       }
+      component[i] = 0;
    }
 }
 
@@ -57,17 +66,7 @@ void GraphM::buildGraph(istream& infile) {
    int fromNode, toNode;      // from and to node ends of edge
    int distance;              // distance between the nodes
 
-   makeEmpty();               // clear the graph of memory 
-
-   infile >> size;            // read the number of nodes
-   if (infile.eof()) return;  // stop if no more data
-   
-   string s;                  // used to read through to end of line
-   getline(infile, s);
-
-   // read graph node information
-   for (int i=1; i <= size; i++)
-      data[i].setData(infile);
+   if (!buildNodes(infile)) return;  // stop if no more data
 
    // read the edge data and add to the adjacency list
    for (;;) {
@@ -76,14 +75,47 @@ void GraphM::buildGraph(istream& infile) {
           || (fromNode < 1    || toNode < 1)    //nodes not in graph
           || (distance < 0)                     //no negative distance
           || (fromNode == 0   && toNode == 0)   //end of edge data
-         ) {
+         )
             return;
 
-         C[fromNode][toNode] = distance;
-      }
+      C[fromNode][toNode] = distance;
    }
 }
 
+//----------------------------- buildNodes --------------------------------
+// Reads the number of nodes and the node names, the first part of the
+// buildGraph input, and leaves the edges unread. Returns false if there
+// was no more data, or the number of nodes is negative or more than
+// getMaxSize
+// Preconditions:   none
+// Assumptions: node names are less than 51 characters in length
+// Postconditions:  GraphM is emptied and holds the nodes, with no edges
+bool GraphM::buildNodes(istream& infile) {
+   makeEmpty();               // clear the graph of memory 
+
+   int nodes = 0;
+   infile >> nodes;           // read the number of nodes
+   if (infile.eof()) return false;  // stop if no more data
+   if (nodes < 0 || nodes > getMaxSize()) return false;  // does not fit
+   
+   string s;                  // used to read through to end of line
+   getline(infile, s);
+
+   // read graph node information
+   size = nodes;
+   for (int i=1; i <= size; i++)
+      data[i].setData(infile);
+   return true;
+}
+
+//----------------------------- getMaxSize --------------------------------
+// Returns the most nodes GraphM can hold
+// Preconditions:   none
+// Postconditions:  none
+int GraphM::getMaxSize() {
+   return MAXNODES - 1;       // index 0 is not used
+}
+
 //---------------------------- makeEmpty ----------------------------------
 // All data members in GraphM are set back to their original values upon
 // upon construction
@@ -95,7 +127,6 @@ void GraphM::makeEmpty() {
          C[i][j] = INT_MAX;         //set cost to "infinity"
 
          T[i][j].dist = INT_MAX;    //intitial distances are "infinity"
-         T[i][j].visited = false;
          T[i][j].path = 0;
       }
    }
@@ -117,6 +148,36 @@ bool GraphM::insertEdge(int fromNode, int toNode, int distance) {
    return true;
 }
 
+//----------------------------- buildEdges --------------------------------
+// Replaces every edge of GraphM with the edges in the array, returns the
+// number of edges stored. Edges with nodes not in GraphM or negative
+// distances are skipped, and the policy decides which distance is kept
+// when an edge appears more than once (see bulkedges.h). T is emptied,
+// since its paths may use edges that are gone
+// Preconditions: the nodes are already in GraphM (see buildGraph)
+// Postconditions: GraphM holds exactly the valid edges of the array, run
+//       findShortestPath again before using T
+int GraphM::buildEdges(const EdgeTriple* edges, int count,
+                       DuplicatePolicy policy) {
+   vector<EdgeTriple> sorted;
+   vector<int> first;
+   sortEdges(edges, count, size, policy, sorted, first);
+
+   //sorted by from node, so each row of C is written once, in order
+   int next = 0;
+   for (int i = 1; i <= size; i++) {
+      for (int j = 1; j <= size; j++) {
+         C[i][j] = INT_MAX;         //set cost to "infinity"
+
+         T[i][j].dist = INT_MAX;    //no paths until findShortestPath
+         T[i][j].path = 0;
+      }
+      for (; next < first[i + 1]; next++)
+         C[i][sorted[next].to] = sorted[next].dist;
+   }
+   return (int)sorted.size();
+}
+
 //----------------------------- removeEdge --------------------------------
 // Remove an edge from GraphM, returns true if to and from nodes were in
 // GraphM
@@ -132,35 +193,74 @@ bool GraphM::removeEdge(int fromNode, int toNode) {
 
 //-------------------------- findShortestPath -----------------------------
 // Find the shortest path from all nodes to all nodes, and fills T with
-// all the information
+// all the information. Builds the reach index first, so each source only
+// looks at nodes it can reach
+// The QueryControl version polls the control once for every node settled,
+// and returns false if it was stopped. T is then emptied again, since a
+// half filled table would give wrong answers
 // Preconditions: none
 // Postconditions: T is filled with all pathing information between all
-//       nodes
+//       nodes, and isReachable can be used
 void GraphM::findShortestPath() {
+   QueryControl control;            //never cancelled, no deadline
+   findShortestPath(control);
+}
+
+bool GraphM::findShortestPath(QueryControl& control) {
+   buildReachIndex();
+
+   //visited marks live in a workspace, not in T
+   QueryWorkspace& work = QueryWorkspace::local();
+   int targets[MAXNODES];           //nodes the source can reach
    for (int source = 1; source <= size; source++) { 
+      //start the row over, it may hold paths from edges since changed
+      for (int j = 1; j <= size; j++) {
+         T[source][j].dist = INT_MAX;
+         T[source][j].path = 0;
+      }
       T[source][source].dist = 0; 
+      work.begin(size);
+
+      //skip every node the source can not reach, their dist stays the
+      //"infinity" set above without ever being scanned
+      int count = 0;
+      for (int j = 1; j <= size; j++)
+         if (reach[component[source]][component[j]])
+            targets[count++] = j;
 
       //find the shortest distance from source to all other nodes 
-      for (int i = 1; i <= size; i++) {
+      for (int i = 0; i < count; i++) {
          int v = -1;
 
          //find the node with smallest distance not visited
          int minDist = INT_MAX;
-         for (int j = 1; j <= size; j++) {
-            if ( T[source][j].dist < minDist && !T[source][j].visited ) {
-               minDist = T[source][j].dist;
-               v = j; //and store the index in v
+         for (int j = 0; j < count; j++) {
+            int u = targets[j];
+            if ( T[source][u].dist < minDist && work.done[u] != work.epoch ) {
+               minDist = T[source][u].dist;
+               v = u; //and store the index in v
             }
          }
 
          //all nodes are either visited or have no paths from source
          if (v == -1) break;
 
-         T[source][v].visited = true;
+         //stopped by the caller, throw away the half filled table
+         if (control.poll()) {
+            for (int r = 1; r <= size; r++)
+               for (int c = 1; c <= size; c++) {
+                  T[r][c].dist = INT_MAX;
+                  T[r][c].path = 0;
+               }
+            return false;
+         }
+
+         work.done[v] = work.epoch;      //visited
 
-         //for each adjacent node not visited
-         for (int w = 1; w <= size; w++) {
-            if (C[v][w] < INT_MAX && !T[source][w].visited) {
+         //for each adjacent node not visited, all of them are targets
+         for (int j = 0; j < count; j++) {
+            int w = targets[j];
+            if (C[v][w] < INT_MAX && work.done[w] != work.epoch) {
                
                //if going through v is better
                if (T[source][v].dist + C[v][w] < T[source][w].dist) {
@@ -175,12 +275,219 @@ void GraphM::findShortestPath() {
          }
       } 
    }
+   return true;
+}
+
+//--------------------------- buildReachIndex -----------------------------
+// Finds the strongly connected components of GraphM, then which
+// components can reach which. Run by findShortestPath, only needs to be
+// called directly to use isReachable without findShortestPath
+// Preconditions: none
+// Postconditions: isReachable answers for the current edges
+void GraphM::buildReachIndex() {
+   //iterative Tarjan. components are numbered in the order they are
+   //finished, so every edge between components goes from a higher
+   //number to a lower one
+   int order[MAXNODES];          //visit number of each node, 0 if unvisited
+   int low[MAXNODES];            //lowest visit number reachable in the tree
+   bool onStack[MAXNODES];       //node is on the component stack
+   int stack[MAXNODES];          //nodes of components not finished yet
+   int callNode[MAXNODES];       //call stack: node being explored
+   int callNext[MAXNODES];       //call stack: next neighbor to try
+   int stackTop = 0, callTop = 0, visitCount = 0;
+
+   for (int i = 1; i <= size; i++) {
+      order[i] = 0;
+      onStack[i] = false;
+   }
+   componentCount = 0;
 
-   //reset visit values so you can call this method again if you want
-   //like maybe you add an edge later on and want to recalculate
-   for (int i = 1; i <= size; i++)
-      for (int j = 1; j <= size; j++)
-         T[i][j].visited = false;
+   for (int root = 1; root <= size; root++) {
+      if (order[root] != 0) continue;
+
+      callNode[callTop] = root;
+      callNext[callTop] = 1;
+      callTop++;
+      order[root] = low[root] = ++visitCount;
+      stack[stackTop++] = root;
+      onStack[root] = true;
+
+      while (callTop > 0) {
+         int v = callNode[callTop - 1];
+         int w = callNext[callTop - 1];
+
+         //find the next neighbor of v
+         while (w <= size && C[v][w] == INT_MAX)
+            w++;
+
+         if (w <= size) {
+            callNext[callTop - 1] = w + 1;
+            if (order[w] == 0) {          //tree edge, explore w
+               callNode[callTop] = w;
+               callNext[callTop] = 1;
+               callTop++;
+               order[w] = low[w] = ++visitCount;
+               stack[stackTop++] = w;
+               onStack[w] = true;
+            } else if (onStack[w] && order[w] < low[v]) {
+               low[v] = order[w];
+            }
+            continue;
+         }
+
+         //v is done, it is the root of a component if low is its own
+         if (low[v] == order[v]) {
+            int u;
+            do {
+               u = stack[--stackTop];
+               onStack[u] = false;
+               component[u] = componentCount;
+            } while (u != v);
+            componentCount++;
+         }
+
+         //return to the parent of v
+         callTop--;
+         if (callTop > 0) {
+            int parent = callNode[callTop - 1];
+            if (low[v] < low[parent])
+               low[parent] = low[v];
+         }
+      }
+   }
+
+   //transitive closure over the condensation, lowest component first so
+   //every component it points to is already complete
+   int first[MAXNODES + 1];      //start of each component in members
+   int members[MAXNODES];        //nodes sorted by component
+   for (int c = 0; c <= componentCount; c++)
+      first[c] = 0;
+   for (int v = 1; v <= size; v++)
+      first[component[v] + 1]++;
+   for (int c = 0; c < componentCount; c++)
+      first[c + 1] += first[c];
+   for (int v = 1; v <= size; v++)
+      members[first[component[v]]++] = v;
+   for (int c = componentCount; c > 0; c--)   //undo the shift from filling
+      first[c] = first[c - 1];
+   first[0] = 0;
+
+   for (int c = 0; c < componentCount; c++) {
+      reach[c].reset();
+      reach[c].set(c);
+      for (int m = first[c]; m < first[c + 1]; m++) {
+         int v = members[m];
+         for (int w = 1; w <= size; w++)
+            if (C[v][w] < INT_MAX && component[w] != c)
+               reach[c] |= reach[component[w]];
+      }
+   }
+}
+
+//----------------------------- isReachable -------------------------------
+// Returns true if there is a path from one node to another, in constant
+// time from the reach index. A node always reaches itself
+// Preconditions: buildReachIndex or findShortestPath has run since the
+//       edges were last changed
+// Postconditions: none
+bool GraphM::isReachable(int fromNode, int toNode) const {
+   //if the nodes inputted are not in GraphM
+   if (fromNode > size || fromNode < 1 || toNode > size || toNode < 1)
+      return false;
+
+   return reach[component[fromNode]][component[toNode]];
+}
+
+//--------------------------- findWithinRadius ----------------------------
+// Finds every other node whose shortest distance from the source is at
+// most the radius. Fills nodes and dists, nearest first, and returns how
+// many nodes were found. Stops as soon as the radius is passed, so only
+// nodes inside the radius are settled
+// Preconditions: no negative radius
+// Postconditions: none, T is not used or changed
+int GraphM::findWithinRadius(int source, int radius, vector<int>& nodes,
+                             vector<int>& dists) const {
+   return findWithinRadius(source, radius, nodes, dists,
+                           QueryWorkspace::local());
+}
+
+int GraphM::findWithinRadius(int source, int radius, vector<int>& nodes,
+                             vector<int>& dists, QueryWorkspace& work) const {
+   return boundedSearch(source, radius, INT_MAX, 0, nodes, dists, work,
+                        NULL);
+}
+
+int GraphM::findWithinRadius(int source, int radius, vector<int>& nodes,
+                             vector<int>& dists, QueryWorkspace& work,
+                             QueryControl& control) const {
+   return boundedSearch(source, radius, INT_MAX, 0, nodes, dists, work,
+                        &control);
+}
+
+//----------------------------- findNearest -------------------------------
+// Finds the k other nodes closest to the source (fewer if fewer can be
+// reached). Fills nodes and dists, nearest first, and returns how many
+// nodes were found. Stops as soon as k nodes are settled
+// Preconditions: none
+// Postconditions: none, T is not used or changed
+int GraphM::findNearest(int source, int k, vector<int>& nodes,
+                        vector<int>& dists) const {
+   return findNearest(source, k, nodes, dists, QueryWorkspace::local());
+}
+
+int GraphM::findNearest(int source, int k, vector<int>& nodes,
+                        vector<int>& dists, QueryWorkspace& work) const {
+   return boundedSearch(source, INT_MAX, k, 0, nodes, dists, work, NULL);
+}
+
+int GraphM::findNearest(int source, int k, vector<int>& nodes,
+                        vector<int>& dists, QueryWorkspace& work,
+                        QueryControl& control) const {
+   return boundedSearch(source, INT_MAX, k, 0, nodes, dists, work, &control);
+}
+
+//------------------------------ findPath ---------------------------------
+// Finds the shortest path from one node to another with Dijkstra from
+// the first node, stopping when the second is settled. Fills the vector
+// with the path, first node first, and returns the distance, INT_MAX if
+// there is no path or the nodes are not in GraphM. With a QueryControl,
+// INT_MAX is also returned if the search was stopped first
+// Preconditions: none
+// Postconditions: none, T is not used or changed
+int GraphM::findPath(int fromNode, int toNode, vector<int>& nodes) const {
+   return findPath(fromNode, toNode, nodes, QueryWorkspace::local());
+}
+
+int GraphM::findPath(int fromNode, int toNode, vector<int>& nodes,
+                     QueryWorkspace& work) const {
+   QueryControl control;            //never cancelled, no deadline
+   return findPath(fromNode, toNode, nodes, work, control);
+}
+
+int GraphM::findPath(int fromNode, int toNode, vector<int>& nodes,
+                     QueryWorkspace& work, QueryControl& control) const {
+   nodes.clear();
+
+   //if the nodes inputted are not in GraphM
+   if (fromNode > size || fromNode < 1 || toNode > size || toNode < 1)
+      return INT_MAX;
+
+   vector<int> found, dists;
+   boundedSearch(fromNode, INT_MAX, INT_MAX, toNode, found, dists, work,
+                 &control);
+   if (work.done[toNode] != work.epoch)     //never settled, or stopped
+      return INT_MAX;
+
+   //walk back from toNode to fromNode through the workspace
+   for (int w = toNode; w != fromNode; w = work.path[w])
+      nodes.push_back(w);
+   nodes.push_back(fromNode);
+   for (size_t i = 0, j = nodes.size() - 1; i < j; i++, j--) {
+      int temp = nodes[i];
+      nodes[i] = nodes[j];
+      nodes[j] = temp;
+   }
+   return work.dist[toNode];
 }
 
 //------------------------------ displayAll -------------------------------
@@ -250,6 +557,162 @@ void GraphM::display(int fromNode, int toNode) const {
    cout << endl;
 }
 
+//------------------------------- getSize ---------------------------------
+// Returns the number of nodes in GraphM
+// Preconditions: none
+// Postconditions: none
+int GraphM::getSize() const {
+   return size;
+}
+
+//----------------------------- getDistance -------------------------------
+// Returns the shortest distance from one node to another, INT_MAX if
+// there is no path or the nodes are not in GraphM
+// Preconditions: findShortestPath has filled T
+// Postconditions: none
+int GraphM::getDistance(int fromNode, int toNode) const {
+   //if the nodes inputted are not in GraphM
+   if (fromNode > size || fromNode < 1 || toNode > size || toNode < 1)
+      return INT_MAX;
+
+   return T[fromNode][toNode].dist;
+}
+
+//------------------------------- getPath ---------------------------------
+// Fills the vector with the nodes on the shortest path from one node to
+// another, first node first, and returns how many nodes are on the path.
+// Returns 0 if there is no path or the nodes are not in GraphM
+// Preconditions: findShortestPath has filled T
+// Postconditions: the vector holds the path
+int GraphM::getPath(int fromNode, int toNode, vector<int>& nodes) const {
+   nodes.clear();
+   if (getDistance(fromNode, toNode) == INT_MAX) //no path
+      return 0;
+
+   //walk back from toNode to fromNode, same walk as displayPathHelper
+   for (int w = toNode; w != fromNode; w = T[fromNode][w].path)
+      nodes.push_back(w);
+   nodes.push_back(fromNode);
+
+   //put fromNode first
+   for (size_t i = 0, j = nodes.size() - 1; i < j; i++, j--) {
+      int temp = nodes[i];
+      nodes[i] = nodes[j];
+      nodes[j] = temp;
+   }
+   return (int)nodes.size();
+}
+
+//-------------------------- findKShortestPaths ---------------------------
+// Finds up to k loopless paths from one node to another, shortest first
+// (Yen). Fills paths with the nodes of each path, first node first, and
+// dists with their distances, and returns how many were found. Each new
+// path only searches again from the nodes after where it left the path
+// it came from, and each spur search is A* guided by the distances to the
+// target already in T. Nodes and edges are taken out of a spur search by
+// stamping them in the workspace, GraphM is never copied or changed.
+// With a QueryControl, the control is polled before each spur search and
+// if stopped, the paths found so far are returned. No paths are found if
+// T does not match the edges any more
+// Preconditions: findShortestPath has filled T
+// Postconditions: none, T is not changed
+int GraphM::findKShortestPaths(int fromNode, int toNode, int k,
+                               vector<vector<int> >& paths,
+                               vector<int>& dists) const {
+   return findKShortestPaths(fromNode, toNode, k, paths, dists,
+                             QueryWorkspace::local());
+}
+
+int GraphM::findKShortestPaths(int fromNode, int toNode, int k,
+                               vector<vector<int> >& paths,
+                               vector<int>& dists,
+                               QueryWorkspace& work) const {
+   QueryControl control;            //never cancelled, no deadline
+   return findKShortestPaths(fromNode, toNode, k, paths, dists, work,
+                             control);
+}
+
+int GraphM::findKShortestPaths(int fromNode, int toNode, int k,
+                               vector<vector<int> >& paths,
+                               vector<int>& dists, QueryWorkspace& work,
+                               QueryControl& control) const {
+   paths.clear();
+   dists.clear();
+
+   //the best path is already in T, and if there is none there are no others
+   vector<int> best;
+   if (k < 1 || getPath(fromNode, toNode, best) == 0)
+      return 0;
+
+   //T is older than the edges if insertEdge or removeEdge ran since
+   //findShortestPath, then its path is not a starting point
+   long long bestDist = 0;
+   for (size_t i = 0; i + 1 < best.size(); i++) {
+      if (C[best[i]][best[i + 1]] == INT_MAX) return 0;
+      bestDist += C[best[i]][best[i + 1]];
+   }
+   if (bestDist != T[fromNode][toNode].dist) return 0;
+   paths.push_back(best);
+   dists.push_back(T[fromNode][toNode].dist);
+   vector<int> deviation(1, 0);     //where each path left its parent
+
+   //candidates ordered by distance, then by nodes so ties come out the
+   //same every time. the value is where the candidate left its parent
+   map<pair<int, vector<int> >, int> candidates;
+
+   while ((int)paths.size() < k) {
+      const vector<int> last = paths.back();
+
+      //spur from every node of the last path from where it left its
+      //parent on, the earlier spur nodes were already tried for the parent
+      int rootDist = 0;
+      for (int i = 0; i < deviation.back(); i++)
+         rootDist += C[last[i]][last[i + 1]];
+
+      for (int i = deviation.back(); i + 1 < (int)last.size(); i++) {
+         if (control.poll()) return (int)paths.size();  //stopped by caller
+         int spur = last[i];
+         work.begin(size);
+
+         //the root may not be walked again, so no loops
+         for (int j = 0; j < i; j++)
+            work.blocked[last[j]] = work.epoch;
+
+         //cut the next edge of every path found that has the same root
+         for (size_t p = 0; p < paths.size(); p++)
+            if (   (int)paths[p].size() > i + 1
+                && equal(last.begin(), last.begin() + i + 1, paths[p].begin())
+               )
+               work.cut[paths[p][i + 1]] = work.epoch;
+
+         int spurDist = spurSearch(spur, toNode, work);
+         if (spurDist != INT_MAX && spurDist <= INT_MAX - rootDist) {
+            //root then spur path, walked back from toNode
+            vector<int> path(last.begin(), last.begin() + i);
+            size_t rootLength = path.size();
+            for (int w = toNode; w != spur; w = work.path[w])
+               path.push_back(w);
+            path.push_back(spur);
+            reverse(path.begin() + rootLength, path.end());
+
+            pair<int, vector<int> > key(rootDist + spurDist, path);
+            if (candidates.find(key) == candidates.end())
+               candidates[key] = i;
+         }
+         rootDist += C[spur][last[i + 1]];
+      }
+
+      //the shortest candidate is the next path
+      if (candidates.empty()) break;
+      map<pair<int, vector<int> >, int>::iterator next = candidates.begin();
+      paths.push_back(next->first.second);
+      dists.push_back(next->first.first);
+      deviation.push_back(next->second);
+      candidates.erase(next);
+   }
+   return (int)paths.size();
+}
+
 //--------------------------- displayPathHelper ---------------------------
 // Helper function for display. Displays one path from one node to another.
 // Preconditions: no negative values allowed, and only edges to and from
@@ -277,3 +740,209 @@ void GraphM::displayPathNamesHelper(int source, int w) const {
    } else if (source == w)                //if we have reached the source
       cout << data[w] << endl;            //display w: first node in path
 }
+
+//---------------------------- boundedSearch ------------------------------
+// Helper for findWithinRadius, findNearest and findPath. Dijkstra from one
+// source that stops when the next node is farther than the radius, when k
+// nodes have been found, or when the target (if not 0) is settled. The
+// control, if not NULL, is polled once for every node settled
+// Preconditions: none
+// Postconditions: nodes and dists hold the nodes found, nearest first.
+//       the workspace holds dist and path of every node settled
+int GraphM::boundedSearch(int source, int radius, int k, int target,
+                          vector<int>& nodes, vector<int>& dists,
+                          QueryWorkspace& work, QueryControl* control) const {
+   nodes.clear();
+   dists.clear();
+
+   //if the source is not in GraphM, or nothing can be asked for
+   if (source > size || source < 1 || radius < 0 || k < 1)
+      return 0;
+
+   work.begin(size);
+   const unsigned int epoch = work.epoch;
+   vector<pair<int, int> >& heap = work.heap;
+   work.seen[source] = epoch;
+   work.dist[source] = 0;
+   work.path[source] = 0;
+   heap.push_back(make_pair(0, source));
+
+   while (!heap.empty()) {
+      //take the closest node not settled yet
+      pop_heap(heap.begin(), heap.end(), greater<pair<int, int> >());
+      int d = heap.back().first;
+      int v = heap.back().second;
+      heap.pop_back();
+      if (work.done[v] == epoch) continue;  //older, longer entry for v
+      if (control != NULL && control->poll()) break;  //stopped by caller
+
+      work.done[v] = epoch;
+      if (v == target) break;               //found the path asked for
+      if (v != source) {
+         nodes.push_back(v);
+         dists.push_back(d);
+         if ((int)nodes.size() == k) break;  //found the k nearest
+      }
+
+      //for each adjacent node not settled, inside the radius
+      for (int w = 1; w <= size; w++) {
+         if (   C[v][w] == INT_MAX || work.done[w] == epoch
+             || C[v][w] > radius - d)      //also keeps d + C from overflow
+            continue;
+
+         //if going through v is better
+         int newDist = d + C[v][w];
+         if (work.seen[w] != epoch || newDist < work.dist[w]) {
+            work.seen[w] = epoch;
+            work.dist[w] = newDist;
+            work.path[w] = v;
+            heap.push_back(make_pair(newDist, w));
+            push_heap(heap.begin(), heap.end(), greater<pair<int, int> >());
+         }
+      }
+   }
+   return (int)nodes.size();
+}
+
+//----------------------------- spurSearch --------------------------------
+// Helper for findKShortestPaths. A* from the spur node (first int) to the
+// target (second int), with T's distance to the target as the heuristic.
+// Skips blocked nodes, and edges out of the spur node to cut nodes.
+// Returns the distance, INT_MAX if the target can not be reached
+// Preconditions: the workspace was started for this search and holds
+//       the blocked and cut stamps. findShortestPath has filled T
+// Postconditions: the workspace path leads back from the target
+int GraphM::spurSearch(int spur, int target, QueryWorkspace& work) const {
+   const unsigned int epoch = work.epoch;
+   vector<pair<int, int> >& heap = work.heap;   //(dist + estimate, node)
+   work.seen[spur] = epoch;
+   work.dist[spur] = 0;
+   work.path[spur] = 0;
+   heap.push_back(make_pair(T[spur][target].dist, spur));
+
+   while (!heap.empty()) {
+      //take the node that looks closest to the target, not settled yet
+      pop_heap(heap.begin(), heap.end(), greater<pair<int, int> >());
+      int v = heap.back().second;
+      heap.pop_back();
+      if (work.done[v] == epoch) continue;  //older, longer entry for v
+
+      work.done[v] = epoch;
+      if (v == target) return work.dist[v];
+
+      //T never overestimates, taking edges out only makes paths longer,
+      //so the first time a node is settled its distance is final
+      int d = work.dist[v];
+      for (int w = 1; w <= size; w++) {
+         if (   C[v][w] == INT_MAX || work.done[w] == epoch
+             || work.blocked[w] == epoch
+             || (v == spur && work.cut[w] == epoch)
+             || T[w][target].dist == INT_MAX     //can never reach target
+             || C[v][w] > INT_MAX - d)
+            continue;
+
+         //if going through v is better
+         int newDist = d + C[v][w];
+         if (   (work.seen[w] != epoch || newDist < work.dist[w])
+             && T[w][target].dist <= INT_MAX - newDist
+            ) {
+            work.seen[w] = epoch;
+            work.dist[w] = newDist;
+            work.path[w] = v;
+            heap.push_back(make_pair(newDist + T[w][target].dist, w));
+            push_heap(heap.begin(), heap.end(), greater<pair<int, int> >());
+         }
+      }
+   }
+   return INT_MAX;
+}
+
+//------------------------------ graphHash --------------------------------
+// Returns a hash of the node names and edges of GraphM. Two graphs with
+// the same hash were built from the same input
+// Preconditions: none
+// Postconditions: none
+unsigned long long GraphM::graphHash() const {
+   //64 bit FNV-1a over size, names, then the cost array row by row
+   unsigned long long hash = 14695981039346656037ULL;
+   const unsigned long long prime = 1099511628211ULL;
+
+   hash = (hash ^ (unsigned long long)size) * prime;
+   for (int i = 1; i <= size; i++) {
+      ostringstream name;
+      name << data[i];
+      string s = name.str();
+      for (size_t c = 0; c < s.length(); c++)
+         hash = (hash ^ (unsigned char)s[c]) * prime;
+      hash = (hash ^ 0xff) * prime;   //end of name, so "ab","c" != "a","bc"
+   }
+   for (int i = 1; i <= size; i++)
+      for (int j = 1; j <= size; j++)
+         hash = (hash ^ (unsigned long long)(unsigned int)C[i][j]) * prime;
+
+   return hash;
+}
+
+//---------------------------- saveSnapshot -------------------------------
+// Saves the distance and path tables, the node names and graphHash to a
+// file that GraphSnapshot can map, returns true if the file was written
+// Preconditions: findShortestPath has filled T
+// Postconditions: the file holds a snapshot of T (see graphsnapshot.h)
+bool GraphM::saveSnapshot(const string& filename) const {
+   int width = size + 1;               //row 0 and column 0 are kept
+   uint64_t cells = (uint64_t)width * width;
+
+   //collect names and where each one starts
+   string allNames;
+   vector<uint32_t> nameIndex(size + 2, 0);
+   for (int i = 1; i <= size; i++) {
+      ostringstream name;
+      name << data[i];
+      nameIndex[i] = (uint32_t)allNames.length();
+      allNames += name.str();
+   }
+   nameIndex[size + 1] = (uint32_t)allNames.length();
+
+   SnapshotHeader header;
+   memset(&header, 0, sizeof(header));
+   strncpy(header.magic, "DJKSNAP", sizeof(header.magic));
+   header.version = SNAPSHOT_VERSION;
+   header.size = size;
+   header.graphHash = graphHash();
+   header.distOffset = sizeof(header);
+   header.pathOffset = header.distOffset + cells * sizeof(int32_t);
+   header.nameIndexOffset = header.pathOffset + cells * sizeof(int32_t);
+   header.nameOffset = header.nameIndexOffset
+                     + nameIndex.size() * sizeof(uint32_t);
+   header.fileSize = header.nameOffset + allNames.length();
+
+   //write to a temporary file first so a reader never maps half a file
+   string tempName = filename + ".tmp";
+   ofstream outfile(tempName.c_str(), ios::binary | ios::trunc);
+   if (!outfile) return false;
+
+   outfile.write((const char*)&header, sizeof(header));
+
+   vector<int32_t> row(width);
+   for (int i = 0; i < width; i++) {
+      for (int j = 0; j < width; j++)
+         row[j] = T[i][j].dist;
+      outfile.write((const char*)&row[0], width * sizeof(int32_t));
+   }
+   for (int i = 0; i < width; i++) {
+      for (int j = 0; j < width; j++)
+         row[j] = T[i][j].path;
+      outfile.write((const char*)&row[0], width * sizeof(int32_t));
+   }
+
+   outfile.write((const char*)&nameIndex[0],
+                 nameIndex.size() * sizeof(uint32_t));
+   outfile.write(allNames.data(), allNames.length());
+   outfile.close();
+
+   if (!outfile || rename(tempName.c_str(), filename.c_str()) != 0) {
+      remove(tempName.c_str());
+      return false;
+   }
+   return true;
+}
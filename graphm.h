@@ -25,7 +25,12 @@
 #include <iostream>
 #include <iomanip>
 #include <limits.h>
+#include <vector>
+#include <bitset>
 #include "nodedata.h"
+#include "bulkedges.h"
+#include "queryworkspace.h"
+#include "querycontrol.h"
 using namespace std;
 
 
@@ -54,6 +59,22 @@ GraphM();
 // Postconditions:  nodes and edges are inputted into GraphM
 void buildGraph(istream&);
 
+//----------------------------- buildNodes --------------------------------
+// Reads the number of nodes and the node names, the first part of the
+// buildGraph input, and leaves the edges unread. Returns false if there
+// was no more data, or the number of nodes is negative or more than
+// getMaxSize
+// Preconditions:   none
+// Assumptions: node names are less than 51 characters in length
+// Postconditions:  GraphM is emptied and holds the nodes, with no edges
+bool buildNodes(istream&);
+
+//----------------------------- getMaxSize --------------------------------
+// Returns the most nodes GraphM can hold
+// Preconditions:   none
+// Postconditions:  none
+static int getMaxSize();
+
 //---------------------------- makeEmpty ----------------------------------
 // All data members in GraphM are set back to their original values upon
 // upon construction
@@ -69,6 +90,17 @@ void makeEmpty();
 //       an edge from node to node, the distance is overwritten
 bool insertEdge(int, int, int);
 
+//----------------------------- buildEdges --------------------------------
+// Replaces every edge of GraphM with the edges in the array, returns the
+// number of edges stored. Edges with nodes not in GraphM or negative
+// distances are skipped, and the policy decides which distance is kept
+// when an edge appears more than once (see bulkedges.h). T is emptied,
+// since its paths may use edges that are gone
+// Preconditions: the nodes are already in GraphM (see buildGraph)
+// Postconditions: GraphM holds exactly the valid edges of the array, run
+//       findShortestPath again before using T
+int buildEdges(const EdgeTriple*, int, DuplicatePolicy);
+
 //----------------------------- removeEdge --------------------------------
 // Remove an edge from GraphM, returns true if to and from nodes were in
 // GraphM
@@ -82,11 +114,69 @@ bool removeEdge(int, int);
 
 //-------------------------- findShortestPath -----------------------------
 // Find the shortest path from all nodes to all nodes, and fills T with
-// all the information
+// all the information. Builds the reach index first, so each source only
+// looks at nodes it can reach
+// The QueryControl version polls the control once for every node settled,
+// and returns false if it was stopped. T is then emptied again, since a
+// half filled table would give wrong answers
 // Preconditions: none
 // Postconditions: T is filled with all pathing information between all
-//       nodes
+//       nodes, and isReachable can be used
 void findShortestPath();
+bool findShortestPath(QueryControl&);
+
+//--------------------------- buildReachIndex -----------------------------
+// Finds the strongly connected components of GraphM, then which
+// components can reach which. Run by findShortestPath, only needs to be
+// called directly to use isReachable without findShortestPath
+// Preconditions: none
+// Postconditions: isReachable answers for the current edges
+void buildReachIndex();
+
+//----------------------------- isReachable -------------------------------
+// Returns true if there is a path from one node to another, in constant
+// time from the reach index. A node always reaches itself
+// Preconditions: buildReachIndex or findShortestPath has run since the
+//       edges were last changed
+// Postconditions: none
+bool isReachable(int, int) const;
+
+//--------------------------- findWithinRadius ----------------------------
+// Finds every other node whose shortest distance from the source is at
+// most the radius. Fills nodes and dists, nearest first, and returns how
+// many nodes were found. Stops as soon as the radius is passed, so only
+// nodes inside the radius are settled
+// Preconditions: no negative radius
+// Postconditions: none, T is not used or changed
+int findWithinRadius(int, int, vector<int>&, vector<int>&) const;
+int findWithinRadius(int, int, vector<int>&, vector<int>&,
+                     QueryWorkspace&) const;
+int findWithinRadius(int, int, vector<int>&, vector<int>&,
+                     QueryWorkspace&, QueryControl&) const;
+
+//----------------------------- findNearest -------------------------------
+// Finds the k other nodes closest to the source (fewer if fewer can be
+// reached). Fills nodes and dists, nearest first, and returns how many
+// nodes were found. Stops as soon as k nodes are settled
+// Preconditions: none
+// Postconditions: none, T is not used or changed
+int findNearest(int, int, vector<int>&, vector<int>&) const;
+int findNearest(int, int, vector<int>&, vector<int>&,
+                QueryWorkspace&) const;
+int findNearest(int, int, vector<int>&, vector<int>&,
+                QueryWorkspace&, QueryControl&) const;
+
+//------------------------------ findPath ---------------------------------
+// Finds the shortest path from one node to another with Dijkstra from
+// the first node, stopping when the second is settled. Fills the vector
+// with the path, first node first, and returns the distance, INT_MAX if
+// there is no path or the nodes are not in GraphM. With a QueryControl,
+// INT_MAX is also returned if the search was stopped first
+// Preconditions: none
+// Postconditions: none, T is not used or changed
+int findPath(int, int, vector<int>&) const;
+int findPath(int, int, vector<int>&, QueryWorkspace&) const;
+int findPath(int, int, vector<int>&, QueryWorkspace&, QueryControl&) const;
 
 //------------------------------ displayAll -------------------------------
 // Displays through cout all of the nodes and the paths inbetween them.
@@ -111,11 +201,64 @@ void displayAll() const;
 // Postconditions: none
 void display(int, int) const;
 
+//------------------------------- getSize ---------------------------------
+// Returns the number of nodes in GraphM
+// Preconditions: none
+// Postconditions: none
+int getSize() const;
+
+//----------------------------- getDistance -------------------------------
+// Returns the shortest distance from one node to another, INT_MAX if
+// there is no path or the nodes are not in GraphM
+// Preconditions: findShortestPath has filled T
+// Postconditions: none
+int getDistance(int, int) const;
+
+//------------------------------- getPath ---------------------------------
+// Fills the vector with the nodes on the shortest path from one node to
+// another, first node first, and returns how many nodes are on the path.
+// Returns 0 if there is no path or the nodes are not in GraphM
+// Preconditions: findShortestPath has filled T
+// Postconditions: the vector holds the path
+int getPath(int, int, vector<int>&) const;
+
+//-------------------------- findKShortestPaths ---------------------------
+// Finds up to k loopless paths from one node to another, shortest first
+// (Yen). Fills paths with the nodes of each path, first node first, and
+// dists with their distances, and returns how many were found. Each new
+// path only searches again from the nodes after where it left the path
+// it came from, and each spur search is A* guided by the distances to the
+// target already in T. Nodes and edges are taken out of a spur search by
+// stamping them in the workspace, GraphM is never copied or changed.
+// With a QueryControl, the control is polled before each spur search and
+// if stopped, the paths found so far are returned. No paths are found if
+// T does not match the edges any more
+// Preconditions: findShortestPath has filled T
+// Postconditions: none, T is not changed
+int findKShortestPaths(int, int, int, vector<vector<int> >&,
+                       vector<int>&) const;
+int findKShortestPaths(int, int, int, vector<vector<int> >&,
+                       vector<int>&, QueryWorkspace&) const;
+int findKShortestPaths(int, int, int, vector<vector<int> >&,
+                       vector<int>&, QueryWorkspace&, QueryControl&) const;
+
+//------------------------------ graphHash --------------------------------
+// Returns a hash of the node names and edges of GraphM. Two graphs with
+// the same hash were built from the same input
+// Preconditions: none
+// Postconditions: none
+unsigned long long graphHash() const;
+
+//---------------------------- saveSnapshot -------------------------------
+// Saves the distance and path tables, the node names and graphHash to a
+// file that GraphSnapshot can map, returns true if the file was written
+// Preconditions: findShortestPath has filled T
+// Postconditions: the file holds a snapshot of T (see graphsnapshot.h)
+bool saveSnapshot(const string&) const;
 
 private:
 
    struct TableType { 
-      bool visited;  // whether node has been visited 
       int dist;      // currently known shortest distance from source 
       int path;      // previous node in path of min dist 
    }; 
@@ -125,7 +268,12 @@ private:
    NodeData data[MAXNODES];         // data for graph nodes information 
    int C[MAXNODES][MAXNODES];       // Cost array, the adjacency matrix 
    int size;                        // number of nodes in the graph 
-   TableType T[MAXNODES][MAXNODES]; // stores visited, distance, path 
+   TableType T[MAXNODES][MAXNODES]; // stores distance, path 
+
+   // reach index, see buildReachIndex
+   int component[MAXNODES];         // strongly connected component of node
+   int componentCount;              // number of components
+   bitset<MAXNODES> reach[MAXNODES]; // components reachable from component
 
 //--------------------------- displayPathHelper ---------------------------
 // Helper function for display. Displays one path from one node to another.
@@ -141,6 +289,27 @@ void displayPathHelper(int, int) const;
 // Postconditions: none
 void displayPathNamesHelper(int, int) const;
 
+//---------------------------- boundedSearch ------------------------------
+// Helper for findWithinRadius, findNearest and findPath. Dijkstra from one
+// source that stops when the next node is farther than the radius, when k
+// nodes have been found, or when the target (if not 0) is settled. The
+// control, if not NULL, is polled once for every node settled
+// Preconditions: none
+// Postconditions: nodes and dists hold the nodes found, nearest first.
+//       the workspace holds dist and path of every node settled
+int boundedSearch(int, int, int, int, vector<int>&, vector<int>&,
+                  QueryWorkspace&, QueryControl*) const;
+
+//----------------------------- spurSearch --------------------------------
+// Helper for findKShortestPaths. A* from the spur node (first int) to the
+// target (second int), with T's distance to the target as the heuristic.
+// Skips blocked nodes, and edges out of the spur node to cut nodes.
+// Returns the distance, INT_MAX if the target can not be reached
+// Preconditions: the workspace was started for this search and holds
+//       the blocked and cut stamps. findShortestPath has filled T
+// Postconditions: the workspace path leads back from the target
+int spurSearch(int, int, QueryWorkspace&) const;
+
 };
 
 #endif
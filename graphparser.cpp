@@ -0,0 +1,381 @@
+//-----------------------------------------------------------------------//
+// GRAPHPARSER.CPP                                                       //
+//                                                                       //
+// GraphParser reads graphs from big data files.  The edge lines of each //
+// graph are split into chunks that are parsed on several threads        //
+//-----------------------------------------------------------------------//
+// Data file: one or more graphs, each laid out as in GraphM::buildGraph //
+//       3                    //number of nodes                          //
+//       Aurora and 85th      //names of each node                       //
+//       Green Lake Starbucks //equal to number of nodes                 //
+//       Woodland Park Zoo                                               //
+//       1 2 50               //edges between each node                  //
+//       1 3 20               //[node1] [node2] [distance]               //
+//       0 0 0                //input 0 0 0 to end input                 //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- one edge per line.  GraphL does not need the distance, GraphM   //
+//       does, Graph is told which.  Blank lines are skipped             //
+//    -- bad edge lines are skipped and reported with their line number, //
+//       the rest of the graph is still read                             //
+//    -- edges are added with buildEdges, so the last of a repeated edge //
+//       is kept, and GraphL edge lists are in order of to node          //
+//    -- the data file is memory mapped, the node names are read one     //
+//       after another, only the edge lines are split across threads     //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#include "graphparser.h"
+#include <sstream>
+#include <thread>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//------------------------------ isBlank ------------------------------------
+// Returns true for the characters that separate values on a line
+static bool isBlank(char c) {
+   return c == ' ' || c == '\t' || c == '\r';
+}
+
+//------------------------------ lineEnd ------------------------------------
+// Returns where the line starting at p ends, the '\n' or end
+static const char* lineEnd(const char* p, const char* end) {
+   const char* newline = (const char*)memchr(p, '\n', end - p);
+   return newline != NULL ? newline : end;
+}
+
+//----------------------------- parseLine -----------------------------------
+// Reads up to three whole numbers from the line [p, end) into values.
+// Returns how many were read, or -1 if something on the line is not a
+// number or there are more than three
+static int parseLine(const char* p, const char* end, int values[3]) {
+   int count = 0;
+   for (;;) {
+      while (p < end && isBlank(*p))
+         p++;
+      if (p == end) return count;
+      if (count == 3) return -1;           //too many values
+
+      bool negative = (*p == '-');
+      if (negative) p++;
+      if (p == end || *p < '0' || *p > '9') return -1;
+
+      long long value = 0;
+      while (p < end && *p >= '0' && *p <= '9') {
+         value = value * 10 + (*p - '0');
+         if (value > INT_MAX) return -1;   //would not fit in an int
+         p++;
+      }
+      if (p < end && !isBlank(*p)) return -1;  //like "12abc"
+
+      values[count++] = (int)(negative ? -value : value);
+   }
+}
+
+//---------------------------- isTerminator ---------------------------------
+// Returns true if the line [p, end) is the 0 0 0 line that ends the edges
+static bool isTerminator(const char* p, const char* end) {
+   //most lines do not start with 0, so check that before parsing
+   const char* first = p;
+   while (first < end && isBlank(*first))
+      first++;
+   if (first == end || *first != '0')
+      return false;
+
+   int values[3];
+   return parseLine(p, end, values) >= 2 && values[0] == 0 && values[1] == 0;
+}
+
+//--------------------------- Constructor ---------------------------------
+// Constructor for class GraphParser, parses with the given number of
+// threads (0 or less for one per hardware thread)
+// Preconditions:   none
+// Postconditions:  no file is open
+GraphParser::GraphParser(int count) {
+   text = NULL;
+   length = 0;
+   position = 0;
+   line = 1;
+   threads = count;
+   if (threads <= 0)
+      threads = (int)thread::hardware_concurrency();
+   if (threads <= 0)                  //hardware count is not known
+      threads = 1;
+}
+
+//---------------------------- Destructor ---------------------------------
+// Destructor for class GraphParser
+// Preconditions:   none
+// Postconditions:  the data file, if any, is released
+GraphParser::~GraphParser() {
+   close();
+}
+
+//------------------------------- open ------------------------------------
+// Maps a data file, returns true if it could be opened
+// Preconditions:   none
+// Postconditions:  the next graph read is the first one in the file
+bool GraphParser::open(const string& filename) {
+   close();
+
+   int fd = ::open(filename.c_str(), O_RDONLY);
+   if (fd < 0) return false;
+
+   struct stat info;
+   if (fstat(fd, &info) != 0) {
+      ::close(fd);
+      return false;
+   }
+   if (info.st_size == 0) {           //nothing to map, no graphs either
+      ::close(fd);
+      return true;
+   }
+
+   void* map = mmap(NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+   ::close(fd);               // the mapping keeps the file alive
+   if (map == MAP_FAILED) return false;
+
+   text = (const char*)map;
+   length = info.st_size;
+   madvise(map, length, MADV_SEQUENTIAL);
+   return true;
+}
+
+//------------------------------- close -----------------------------------
+// Releases the data file
+// Preconditions:   none
+// Postconditions:  no file is open
+void GraphParser::close() {
+   if (text != NULL)
+      munmap((void*)text, length);
+   text = NULL;
+   length = 0;
+   position = 0;
+   line = 1;
+   errors.clear();
+}
+
+//------------------------------ nextGraph --------------------------------
+// Reads the next graph in the file into the graph, returns false if there
+// are no more graphs. Bad edge lines are in getErrors afterwards. For
+// Graph the bool says whether edge lines have a distance. A graph with
+// more nodes than the graph can hold is skipped and false is returned,
+// with its number of nodes line in getErrors
+// Preconditions:   a file is open
+// Postconditions:  if true, the graph holds the nodes and edges read
+bool GraphParser::nextGraph(GraphM& graph) {
+   string header;
+   vector<EdgeTriple> edges;
+   if (!nextSection(header, edges, true, GraphM::getMaxSize()))
+      return false;
+
+   istringstream nodes(header);
+   graph.buildNodes(nodes);
+   graph.buildEdges(edges.empty() ? NULL : &edges[0], (int)edges.size(),
+                    KEEP_LAST);
+   return true;
+}
+
+bool GraphParser::nextGraph(GraphL& graph) {
+   string header;
+   vector<EdgeTriple> edges;
+   if (!nextSection(header, edges, false, GraphL::getMaxSize()))
+      return false;
+
+   istringstream nodes(header);
+   graph.buildNodes(nodes);
+   graph.buildEdges(edges.empty() ? NULL : &edges[0], (int)edges.size());
+   return true;
+}
+
+bool GraphParser::nextGraph(Graph& graph, bool weighted) {
+   string header;
+   vector<EdgeTriple> edges;
+   if (!nextSection(header, edges, weighted, INT_MAX))
+      return false;
+
+   istringstream nodes(header);
+   graph.buildNodes(nodes);
+   graph.buildEdges(edges.empty() ? NULL : &edges[0], (int)edges.size(),
+                    weighted);
+   return true;
+}
+
+//------------------------------ getErrors --------------------------------
+// Returns the bad lines of the last graph read, in file order
+// Preconditions:   none
+// Postconditions:  none
+const vector<ParseError>& GraphParser::getErrors() const {
+   return errors;
+}
+
+//----------------------------- nextSection -------------------------------
+// Helper for nextGraph. Finds the node lines of the next graph and puts
+// them in header, then parses its edge lines into edges and moves past
+// the 0 0 0 line. Edges need a distance if the bool is true. Returns
+// false if there are no more graphs, or if the number of nodes is
+// negative or more than the int, which is then added to errors
+// Preconditions:   a file is open
+// Postconditions:  errors holds the bad edge lines
+bool GraphParser::nextSection(string& header, vector<EdgeTriple>& edges,
+                              bool weighted, int maxSize) {
+   errors.clear();
+   edges.clear();
+   if (text == NULL) return false;
+
+   const char* end = text + length;
+   const char* p = text + position;
+
+   //skip to the number of nodes, like infile >> size
+   while (p < end && (isBlank(*p) || *p == '\n')) {
+      if (*p == '\n') line++;
+      p++;
+   }
+   const char* lineStart = p;
+   const char* stop = lineEnd(p, end);
+   int values[3];
+   if (p == end || parseLine(p, stop, values) < 1) {
+      position = length;
+      return false;                    //no more graphs
+   }
+   int size = values[0];
+   long long sizeLine = line;
+
+   //the node lines follow the number of nodes, one name per line
+   p = stop;
+   for (int i = 0; i < size && p < end; i++) {
+      p++;                             //past the '\n'
+      line++;
+      p = lineEnd(p, end);
+   }
+   if (p < end) {                      //past the last '\n' of the nodes
+      p++;
+      line++;
+   }
+   header.assign(lineStart, p);
+
+   //find the 0 0 0 line, one line after another. this only looks at the
+   //first character of most lines, the parsing is done in chunks below
+   const char* edgeStart = p;
+   long long edgeLine = line;
+   while (p < end) {
+      stop = lineEnd(p, end);
+      if (isTerminator(p, stop)) break;
+      p = stop < end ? stop + 1 : end;
+      line++;
+   }
+   const char* edgeEnd = p;
+
+   //move past the 0 0 0 line for the next graph
+   if (p < end) {
+      stop = lineEnd(p, end);
+      p = stop < end ? stop + 1 : end;
+      line++;
+   }
+   position = p - text;
+
+   //the graph was skipped whole, so the next one is still found
+   if (size < 0 || size > maxSize) {
+      ParseError error = { sizeLine, size < 0 ? "negative number of nodes"
+                                              : "too many nodes" };
+      errors.push_back(error);
+      header.clear();
+      return false;
+   }
+
+   //split the edge lines into chunks that start at the start of a line
+   long long bytes = edgeEnd - edgeStart;
+   int chunks = (int)(bytes / CHUNK);
+   if (chunks > threads) chunks = threads;
+   if (chunks < 1) chunks = 1;
+
+   vector<const char*> bound(chunks + 1);
+   bound[0] = edgeStart;
+   bound[chunks] = edgeEnd;
+   for (int c = 1; c < chunks; c++) {
+      const char* cut = edgeStart + bytes * c / chunks;
+      if (cut < bound[c - 1]) cut = bound[c - 1];
+      cut = lineEnd(cut, edgeEnd);
+      bound[c] = cut < edgeEnd ? cut + 1 : edgeEnd;
+   }
+
+   vector<vector<EdgeTriple> > chunkEdges(chunks);
+   vector<vector<ParseError> > chunkErrors(chunks);
+   vector<long long> chunkLines(chunks);
+   if (chunks == 1) {
+      chunkLines[0] = parseChunk(bound[0], bound[1], size, weighted,
+                                 chunkEdges[0], chunkErrors[0]);
+   } else {
+      vector<thread> workers;
+      for (int c = 0; c < chunks; c++)
+         workers.push_back(thread([&, c]() {
+            chunkLines[c] = parseChunk(bound[c], bound[c + 1], size,
+                                       weighted, chunkEdges[c],
+                                       chunkErrors[c]);
+         }));
+      for (int c = 0; c < chunks; c++)
+         workers[c].join();
+   }
+
+   //merge the chunks in file order, errors get file line numbers
+   size_t total = 0;
+   for (int c = 0; c < chunks; c++)
+      total += chunkEdges[c].size();
+   edges.reserve(total);
+   for (int c = 0; c < chunks; c++) {
+      edges.insert(edges.end(), chunkEdges[c].begin(), chunkEdges[c].end());
+      for (size_t i = 0; i < chunkErrors[c].size(); i++) {
+         errors.push_back(chunkErrors[c][i]);
+         errors.back().line += edgeLine;
+      }
+      edgeLine += chunkLines[c];
+   }
+   return true;
+}
+
+//----------------------------- parseChunk --------------------------------
+// Helper for nextSection. Parses the edge lines in [begin, end) into
+// edges, and every bad line into errors with its line number counted
+// from the start of the chunk. The int is the number of nodes, edges need
+// a distance if the bool is true. Returns the number of lines in the chunk
+// Preconditions:   the chunk starts at the start of a line
+// Postconditions:  none
+long long GraphParser::parseChunk(const char* begin, const char* end,
+                                  int size, bool weighted,
+                                  vector<EdgeTriple>& edges,
+                                  vector<ParseError>& errors) {
+   long long lines = 0;
+   for (const char* p = begin; p < end; lines++) {
+      const char* stop = lineEnd(p, end);
+      int values[3];
+      int count = parseLine(p, stop, values);
+      p = stop < end ? stop + 1 : end;
+
+      const char* reason = NULL;
+      if (count == 0) continue;                      //blank line
+      if (count < 0)
+         reason = "not a number, or too many values";
+      else if (count == 1)
+         reason = "missing node";
+      else if (weighted && count == 2)
+         reason = "missing distance";
+      else if (   values[0] > size || values[1] > size   //nodes not in graph
+               || values[0] < 1    || values[1] < 1)     //nodes not in graph
+         reason = "node not in graph";
+      else if (weighted && values[2] < 0)
+         reason = "negative distance";
+
+      if (reason != NULL) {
+         ParseError error = { lines, reason };
+         errors.push_back(error);
+         continue;
+      }
+
+      EdgeTriple edge = { values[0], values[1], weighted ? values[2] : 0 };
+      edges.push_back(edge);
+   }
+   return lines;
+}
@@ -0,0 +1,126 @@
+//-----------------------------------------------------------------------//
+// GRAPHPARSER.H                                                         //
+//                                                                       //
+// GraphParser reads graphs from big data files.  The edge lines of each //
+// graph are split into chunks that are parsed on several threads        //
+//-----------------------------------------------------------------------//
+// Data file: one or more graphs, each laid out as in GraphM::buildGraph //
+//       3                    //number of nodes                          //
+//       Aurora and 85th      //names of each node                       //
+//       Green Lake Starbucks //equal to number of nodes                 //
+//       Woodland Park Zoo                                               //
+//       1 2 50               //edges between each node                  //
+//       1 3 20               //[node1] [node2] [distance]               //
+//       0 0 0                //input 0 0 0 to end input                 //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- one edge per line.  GraphL does not need the distance, GraphM   //
+//       does, Graph is told which.  Blank lines are skipped             //
+//    -- bad edge lines are skipped and reported with their line number, //
+//       the rest of the graph is still read                             //
+//    -- edges are added with buildEdges, so the last of a repeated edge //
+//       is kept, and GraphL edge lists are in order of to node          //
+//    -- the data file is memory mapped, the node names are read one     //
+//       after another, only the edge lines are split across threads     //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#ifndef GRAPHPARSER_H
+#define GRAPHPARSER_H
+#include <string>
+#include <vector>
+#include "graphm.h"
+#include "graphl.h"
+#include "graph.h"
+#include "bulkedges.h"
+using namespace std;
+
+// one bad edge line
+struct ParseError {
+   long long line;           // line number in the data file, from 1
+   string reason;            // what is wrong with the line
+};
+
+class GraphParser {
+
+public:
+//--------------------------- Constructor ---------------------------------
+// Constructor for class GraphParser, parses with the given number of
+// threads (0 or less for one per hardware thread)
+// Preconditions:   none
+// Postconditions:  no file is open
+GraphParser(int);
+
+//---------------------------- Destructor ---------------------------------
+// Destructor for class GraphParser
+// Preconditions:   none
+// Postconditions:  the data file, if any, is released
+~GraphParser();
+
+//------------------------------- open ------------------------------------
+// Maps a data file, returns true if it could be opened
+// Preconditions:   none
+// Postconditions:  the next graph read is the first one in the file
+bool open(const string&);
+
+//------------------------------- close -----------------------------------
+// Releases the data file
+// Preconditions:   none
+// Postconditions:  no file is open
+void close();
+
+//------------------------------ nextGraph --------------------------------
+// Reads the next graph in the file into the graph, returns false if there
+// are no more graphs. Bad edge lines are in getErrors afterwards. For
+// Graph the bool says whether edge lines have a distance. A graph with
+// more nodes than the graph can hold is skipped and false is returned,
+// with its number of nodes line in getErrors
+// Preconditions:   a file is open
+// Postconditions:  if true, the graph holds the nodes and edges read
+bool nextGraph(GraphM&);
+bool nextGraph(GraphL&);
+bool nextGraph(Graph&, bool);
+
+//------------------------------ getErrors --------------------------------
+// Returns the bad lines of the last graph read, in file order
+// Preconditions:   none
+// Postconditions:  none
+const vector<ParseError>& getErrors() const;
+
+private:
+
+   static const long long CHUNK = 1 << 20;  // fewest bytes per thread
+
+   const char* text;                // start of the mapped file
+   size_t length;                   // bytes mapped
+   size_t position;                 // start of the next graph
+   long long line;                  // line number at position
+   int threads;                     // most threads to parse with
+   vector<ParseError> errors;       // bad lines of the last graph
+
+   GraphParser(const GraphParser&);             // not copyable
+   GraphParser& operator=(const GraphParser&);
+
+//----------------------------- nextSection -------------------------------
+// Helper for nextGraph. Finds the node lines of the next graph and puts
+// them in header, then parses its edge lines into edges and moves past
+// the 0 0 0 line. Edges need a distance if the bool is true. Returns
+// false if there are no more graphs, or if the number of nodes is
+// negative or more than the int, which is then added to errors
+// Preconditions:   a file is open
+// Postconditions:  errors holds the bad edge lines
+bool nextSection(string&, vector<EdgeTriple>&, bool, int);
+
+//----------------------------- parseChunk --------------------------------
+// Helper for nextSection. Parses the edge lines in [begin, end) into
+// edges, and every bad line into errors with its line number counted
+// from the start of the chunk. The int is the number of nodes, edges need
+// a distance if the bool is true. Returns the number of lines in the chunk
+// Preconditions:   the chunk starts at the start of a line
+// Postconditions:  none
+static long long parseChunk(const char*, const char*, int, bool,
+                            vector<EdgeTriple>&, vector<ParseError>&);
+
+};
+
+#endif
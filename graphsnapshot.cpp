@@ -0,0 +1,238 @@
+//-----------------------------------------------------------------------//
+// GRAPHSNAPSHOT.CPP                                                     //
+//                                                                       //
+// GraphSnapshot answers display queries from a shortest path table that //
+// GraphM saved to disk, without running findShortestPath again          //
+//-----------------------------------------------------------------------//
+// Snapshot file: written by GraphM::saveSnapshot. Holds a header, the   //
+//        distance table, the path table and the node names.  The file  //
+//        is memory mapped and read in place, nothing is copied.         //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- snapshots are read on a machine with the same byte order and    //
+//       int size as the machine that wrote them                         //
+//    -- tables are (size + 1) x (size + 1), row 0 and column 0 unused,  //
+//       so that node numbers are equal to index number like GraphM      //
+//    -- a snapshot is only accepted if its graph hash matches the hash  //
+//       of the graph the caller expects (see GraphM::graphHash)         //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#include "graphsnapshot.h"
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//-------------------------- Constructor ----------------------------------
+// Default constructor for class GraphSnapshot
+// Preconditions:   none
+// Postconditions:  no file is mapped and size is 0
+GraphSnapshot::GraphSnapshot() {
+   base = NULL;
+   length = 0;
+   size = 0;
+   dist = NULL;
+   path = NULL;
+   nameIndex = NULL;
+   names = NULL;
+}
+
+//---------------------------- Destructor ---------------------------------
+// Destructor for class GraphSnapshot
+// Preconditions:   none
+// Postconditions:  the mapped file, if any, is released
+GraphSnapshot::~GraphSnapshot() {
+   close();
+}
+
+//------------------------------- open ------------------------------------
+// Maps a snapshot file written by GraphM::saveSnapshot, returns true if
+// the file is a valid snapshot of the graph with the given hash
+// Preconditions:   none
+// Postconditions:  if true, queries read from the mapped file. if false,
+//       no file is mapped
+bool GraphSnapshot::open(const string& filename, unsigned long long hash) {
+   close();
+
+   int fd = ::open(filename.c_str(), O_RDONLY);
+   if (fd < 0) return false;
+
+   struct stat info;
+   if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(SnapshotHeader)) {
+      ::close(fd);
+      return false;
+   }
+
+   void* map = mmap(NULL, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+   ::close(fd);               // the mapping keeps the file alive
+   if (map == MAP_FAILED) return false;
+
+   base = (const char*)map;
+   length = info.st_size;
+
+   //check the header before trusting any offset in it
+   const SnapshotHeader* header = (const SnapshotHeader*)base;
+   uint64_t cells = 0;
+   if (header->size >= 0)
+      cells = (uint64_t)(header->size + 1) * (header->size + 1);
+   uint64_t indexCount = (uint64_t)header->size + 2;
+
+   if (   strncmp(header->magic, "DJKSNAP", sizeof(header->magic)) != 0
+       || header->version != SNAPSHOT_VERSION   //written by other version
+       || header->graphHash != hash             //not the caller's graph
+       || header->size < 0
+       || header->fileSize != length            //truncated or appended to
+       || header->distOffset + cells * sizeof(int32_t) > length
+       || header->pathOffset + cells * sizeof(int32_t) > length
+       || header->nameIndexOffset + indexCount * sizeof(uint32_t) > length
+       || header->nameOffset > length
+      ) {
+      close();
+      return false;
+   }
+
+   dist = (const int32_t*)(base + header->distOffset);
+   path = (const int32_t*)(base + header->pathOffset);
+   nameIndex = (const uint32_t*)(base + header->nameIndexOffset);
+   names = base + header->nameOffset;
+
+   //names must be in order and inside the file
+   for (int i = 1; i <= header->size; i++) {
+      if (   nameIndex[i] > nameIndex[i + 1]
+          || header->nameOffset + nameIndex[i + 1] > length) {
+         close();
+         return false;
+      }
+   }
+
+   size = header->size;
+   return true;
+}
+
+//------------------------------- close -----------------------------------
+// Releases the mapped file
+// Preconditions:   none
+// Postconditions:  no file is mapped and size is 0
+void GraphSnapshot::close() {
+   if (base != NULL)
+      munmap((void*)base, length);
+   base = NULL;
+   length = 0;
+   size = 0;
+   dist = NULL;
+   path = NULL;
+   nameIndex = NULL;
+   names = NULL;
+}
+
+//------------------------------ isOpen -----------------------------------
+// Returns true if a snapshot is mapped
+// Preconditions:   none
+// Postconditions:  none
+bool GraphSnapshot::isOpen() const {
+   return base != NULL;
+}
+
+//------------------------------ getSize ----------------------------------
+// Returns the number of nodes in the mapped snapshot, 0 if none
+// Preconditions:   none
+// Postconditions:  none
+int GraphSnapshot::getSize() const {
+   return size;
+}
+
+//---------------------------- getDistance --------------------------------
+// Returns the shortest distance from one node to another, INT_MAX if
+// there is no path or the nodes are not in the snapshot
+// Preconditions:   none
+// Postconditions:  none
+int GraphSnapshot::getDistance(int fromNode, int toNode) const {
+   //if the nodes inputted are not in the snapshot
+   if (fromNode > size || fromNode < 1 || toNode > size || toNode < 1)
+      return INT_MAX;
+
+   return dist[fromNode * (size + 1) + toNode];
+}
+
+//-------------------------------- display --------------------------------
+// Displays one path from one node to another, same format as
+// GraphM::display
+// [node1] [node2] [distance] [pathing]
+// [names of path nodes]
+// Preconditions: only nodes that are in the snapshot
+// Postconditions: none
+void GraphSnapshot::display(int fromNode, int toNode) const {
+   //if the nodes inputted are not in the snapshot
+   if (fromNode > size || fromNode < 1 || toNode > size || toNode < 1)
+      return;
+
+   //display fromNode and toNode
+   cout << setw(5) << fromNode << setw(5) << toNode;
+
+   //display distance
+   int d = getDistance(fromNode, toNode);
+   if (d < INT_MAX) //if there is a path
+      cout << setw(10) << d;
+   else //if no path
+      cout << setw(10) << "----";
+
+   //display pathing
+   vector<int> nodes;
+   int count = pathNodes(fromNode, toNode, nodes);
+   for (int i = 0; i < count; i++)
+      cout << nodes[i] << " ";
+   cout << endl;
+
+   //display names of path nodes
+   for (int i = 0; i < count; i++) {
+      displayName(nodes[i]);
+      cout << endl;
+   }
+   cout << endl;
+}
+
+//----------------------------- pathNodes ---------------------------------
+// Helper for display. Fills nodes with the path from one node to another,
+// first node first, and returns how many nodes are on the path. A broken
+// path table can not loop forever, the walk stops after size steps
+// Preconditions: none
+// Postconditions: nodes holds the path
+int GraphSnapshot::pathNodes(int source, int w, vector<int>& nodes) const {
+   nodes.clear();
+   const int32_t* row = path + source * (size + 1);
+
+   //walk back from w to the source
+   while (w != source && nodes.size() <= (size_t)size) {
+      int v = row[w];
+      if (v < 1 || v > size) {   //no path, or a broken table
+         nodes.clear();
+         return 0;
+      }
+      nodes.push_back(w);
+      w = v;
+   }
+   if (w != source) {
+      nodes.clear();
+      return 0;
+   }
+   nodes.push_back(source);
+
+   //put the source first
+   for (size_t i = 0, j = nodes.size() - 1; i < j; i++, j--) {
+      int temp = nodes[i];
+      nodes[i] = nodes[j];
+      nodes[j] = temp;
+   }
+   return (int)nodes.size();
+}
+
+//----------------------------- displayName -------------------------------
+// Helper for display. Displays the name of one node straight out of the
+// mapped file
+// Preconditions: none
+// Postconditions: none
+void GraphSnapshot::displayName(int node) const {
+   cout.write(names + nameIndex[node], nameIndex[node + 1] - nameIndex[node]);
+}
@@ -0,0 +1,134 @@
+//-----------------------------------------------------------------------//
+// GRAPHSNAPSHOT.H                                                       //
+//                                                                       //
+// GraphSnapshot answers display queries from a shortest path table that //
+// GraphM saved to disk, without running findShortestPath again          //
+//-----------------------------------------------------------------------//
+// Snapshot file: written by GraphM::saveSnapshot. Holds a header, the   //
+//        distance table, the path table and the node names.  The file  //
+//        is memory mapped and read in place, nothing is copied.         //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- snapshots are read on a machine with the same byte order and    //
+//       int size as the machine that wrote them                         //
+//    -- tables are (size + 1) x (size + 1), row 0 and column 0 unused,  //
+//       so that node numbers are equal to index number like GraphM      //
+//    -- a snapshot is only accepted if its graph hash matches the hash  //
+//       of the graph the caller expects (see GraphM::graphHash)         //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#ifndef GRAPHSNAPSHOT_H
+#define GRAPHSNAPSHOT_H
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <limits.h>
+#include <stdint.h>
+using namespace std;
+
+// on-disk layout of the start of a snapshot file, offsets are in bytes
+// from the start of the file
+struct SnapshotHeader {
+   char magic[8];            // "DJKSNAP" and a terminating '\0'
+   uint32_t version;         // SNAPSHOT_VERSION of the writer
+   int32_t size;             // number of nodes in the graph
+   uint64_t graphHash;       // GraphM::graphHash of the input graph
+   uint64_t distOffset;      // int32 table of shortest distances
+   uint64_t pathOffset;      // int32 table of previous nodes in path
+   uint64_t nameIndexOffset; // uint32 name start offsets, size + 2 long
+   uint64_t nameOffset;      // characters of all names, back to back
+   uint64_t fileSize;        // total bytes in the file
+};
+
+const uint32_t SNAPSHOT_VERSION = 1;
+
+class GraphSnapshot {
+
+public:
+//-------------------------- Constructor ----------------------------------
+// Default constructor for class GraphSnapshot
+// Preconditions:   none
+// Postconditions:  no file is mapped and size is 0
+GraphSnapshot();
+
+//---------------------------- Destructor ---------------------------------
+// Destructor for class GraphSnapshot
+// Preconditions:   none
+// Postconditions:  the mapped file, if any, is released
+~GraphSnapshot();
+
+//------------------------------- open ------------------------------------
+// Maps a snapshot file written by GraphM::saveSnapshot, returns true if
+// the file is a valid snapshot of the graph with the given hash
+// Preconditions:   none
+// Postconditions:  if true, queries read from the mapped file. if false,
+//       no file is mapped
+bool open(const string&, unsigned long long);
+
+//------------------------------- close -----------------------------------
+// Releases the mapped file
+// Preconditions:   none
+// Postconditions:  no file is mapped and size is 0
+void close();
+
+//------------------------------ isOpen -----------------------------------
+// Returns true if a snapshot is mapped
+// Preconditions:   none
+// Postconditions:  none
+bool isOpen() const;
+
+//------------------------------ getSize ----------------------------------
+// Returns the number of nodes in the mapped snapshot, 0 if none
+// Preconditions:   none
+// Postconditions:  none
+int getSize() const;
+
+//---------------------------- getDistance --------------------------------
+// Returns the shortest distance from one node to another, INT_MAX if
+// there is no path or the nodes are not in the snapshot
+// Preconditions:   none
+// Postconditions:  none
+int getDistance(int, int) const;
+
+//-------------------------------- display --------------------------------
+// Displays one path from one node to another, same format as
+// GraphM::display
+// [node1] [node2] [distance] [pathing]
+// [names of path nodes]
+// Preconditions: only nodes that are in the snapshot
+// Postconditions: none
+void display(int, int) const;
+
+private:
+
+   const char* base;          // start of the mapped file
+   size_t length;             // bytes mapped
+   int size;                  // number of nodes in the graph
+   const int32_t* dist;       // distance table inside the mapping
+   const int32_t* path;       // path table inside the mapping
+   const uint32_t* nameIndex; // name start offsets inside the mapping
+   const char* names;         // name characters inside the mapping
+
+   GraphSnapshot(const GraphSnapshot&);            // not copyable
+   GraphSnapshot& operator=(const GraphSnapshot&);
+
+//----------------------------- pathNodes ---------------------------------
+// Helper for display. Fills nodes with the path from one node to another,
+// first node first, and returns how many nodes are on the path. A broken
+// path table can not loop forever, the walk stops after size steps
+// Preconditions: none
+// Postconditions: nodes holds the path
+int pathNodes(int, int, vector<int>&) const;
+
+//----------------------------- displayName -------------------------------
+// Helper for display. Displays the name of one node straight out of the
+// mapped file
+// Preconditions: none
+// Postconditions: none
+void displayName(int) const;
+
+};
+
+#endif
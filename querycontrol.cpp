@@ -0,0 +1,82 @@
+//-----------------------------------------------------------------------//
+// QUERYCONTROL.CPP                                                      //
+//                                                                       //
+// QueryControl lets a caller stop a graph search that is running on     //
+// another thread, by cancelling it or by giving it a deadline           //
+//-----------------------------------------------------------------------//
+// Polling: a search calls poll from its main loop.  poll returns true   //
+//        once the search is cancelled or past its deadline, and the     //
+//        search then returns whatever it has found so far.              //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- cancel can be called from any thread at any time                //
+//    -- setTimeout is called before the search starts, and poll is      //
+//       only called by the one thread running the search                //
+//    -- the cancel flag is read on every poll, the clock only on every  //
+//       CHECK_EVERY'th poll, so polling is cheap enough for inner loops //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#include "querycontrol.h"
+
+//--------------------------- Constructor ---------------------------------
+// Default constructor for class QueryControl
+// Preconditions:   none
+// Postconditions:  not cancelled, no deadline, status is QUERY_DONE
+QueryControl::QueryControl() : cancelled(false), status(QUERY_DONE) {
+   hasDeadline = false;
+   calls = 0;
+}
+
+//------------------------------- cancel ----------------------------------
+// Asks the search to stop. Safe to call from any thread
+// Preconditions:   none
+// Postconditions:  the next poll returns true
+void QueryControl::cancel() {
+   cancelled = true;
+}
+
+//----------------------------- setTimeout --------------------------------
+// Sets the deadline to the given number of milliseconds from now. 0 or
+// less means no deadline
+// Preconditions:   the search has not started
+// Postconditions:  poll returns true once the deadline has passed
+void QueryControl::setTimeout(int milliseconds) {
+   hasDeadline = milliseconds > 0;
+   if (hasDeadline)
+      deadline = chrono::steady_clock::now()
+               + chrono::milliseconds(milliseconds);
+   calls = 0;                       //next poll reads the clock
+}
+
+//-------------------------------- poll -----------------------------------
+// Returns true if the search should stop. The first poll and every
+// CHECK_EVERY'th poll after it also read the clock
+// Preconditions:   only called by the thread running the search
+// Postconditions:  if true, getStatus tells why
+bool QueryControl::poll() {
+   if (status != QUERY_DONE)        //already stopped, stay stopped
+      return true;
+
+   if (cancelled) {
+      status = QUERY_CANCELLED;
+      return true;
+   }
+
+   if (hasDeadline && calls-- == 0) {
+      calls = CHECK_EVERY - 1;
+      if (chrono::steady_clock::now() >= deadline) {
+         status = QUERY_TIMED_OUT;
+         return true;
+      }
+   }
+   return false;
+}
+
+//------------------------------ getStatus --------------------------------
+// Returns QUERY_DONE, unless a poll has returned true
+// Preconditions:   none
+// Postconditions:  none
+QueryStatus QueryControl::getStatus() const {
+   return (QueryStatus)status.load();
+}
@@ -0,0 +1,83 @@
+//-----------------------------------------------------------------------//
+// QUERYCONTROL.H                                                        //
+//                                                                       //
+// QueryControl lets a caller stop a graph search that is running on     //
+// another thread, by cancelling it or by giving it a deadline           //
+//-----------------------------------------------------------------------//
+// Polling: a search calls poll from its main loop.  poll returns true   //
+//        once the search is cancelled or past its deadline, and the     //
+//        search then returns whatever it has found so far.              //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- cancel can be called from any thread at any time                //
+//    -- setTimeout is called before the search starts, and poll is      //
+//       only called by the one thread running the search                //
+//    -- the cancel flag is read on every poll, the clock only on every  //
+//       CHECK_EVERY'th poll, so polling is cheap enough for inner loops //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#ifndef QUERYCONTROL_H
+#define QUERYCONTROL_H
+#include <atomic>
+#include <chrono>
+using namespace std;
+
+// how a search ended
+enum QueryStatus {
+   QUERY_DONE,               // ran to the end, the answer is complete
+   QUERY_CANCELLED,          // stopped because cancel was called
+   QUERY_TIMED_OUT           // stopped because the deadline passed
+};
+
+class QueryControl {
+
+public:
+//--------------------------- Constructor ---------------------------------
+// Default constructor for class QueryControl
+// Preconditions:   none
+// Postconditions:  not cancelled, no deadline, status is QUERY_DONE
+QueryControl();
+
+//------------------------------- cancel ----------------------------------
+// Asks the search to stop. Safe to call from any thread
+// Preconditions:   none
+// Postconditions:  the next poll returns true
+void cancel();
+
+//----------------------------- setTimeout --------------------------------
+// Sets the deadline to the given number of milliseconds from now. 0 or
+// less means no deadline
+// Preconditions:   the search has not started
+// Postconditions:  poll returns true once the deadline has passed
+void setTimeout(int);
+
+//-------------------------------- poll -----------------------------------
+// Returns true if the search should stop. The first poll and every
+// CHECK_EVERY'th poll after it also read the clock
+// Preconditions:   only called by the thread running the search
+// Postconditions:  if true, getStatus tells why
+bool poll();
+
+//------------------------------ getStatus --------------------------------
+// Returns QUERY_DONE, unless a poll has returned true
+// Preconditions:   none
+// Postconditions:  none
+QueryStatus getStatus() const;
+
+private:
+
+   static const int CHECK_EVERY = 64;   // polls between clock reads
+
+   atomic<bool> cancelled;          // set by cancel
+   atomic<int> status;              // a QueryStatus, set by poll
+   bool hasDeadline;                // false if setTimeout was not used
+   chrono::steady_clock::time_point deadline;  // when to stop
+   int calls;                       // polls since the clock was read
+
+   QueryControl(const QueryControl&);             // not copyable
+   QueryControl& operator=(const QueryControl&);
+
+};
+
+#endif
@@ -0,0 +1,515 @@
+//-----------------------------------------------------------------------//
+// QUERYSERVER.CPP                                                       //
+//                                                                       //
+// QueryServer answers shortest path questions about one GraphM that is  //
+// loaded once, over a stream (stdin) or a Unix domain socket            //
+//-----------------------------------------------------------------------//
+// Protocol: one request per line, one reply line per request, replies   //
+//        in the same order as the requests.  Node numbers as in GraphM. //
+//           P from to  ->  OK dist n1 n2 .. nk   (path)  or  NONE       //
+//           D from to  ->  OK dist                       or  NONE       //
+//           R from to  ->  OK 1  (reachable)  or  OK 0                  //
+//           A from to k -> OK dist n1 .. nk; dist ..  or  NONE          //
+//                          (k shortest loopless paths, shortest first)  //
+//           N from r   ->  OK n1:d1 .. nk:dk  (within distance r)       //
+//           K from k   ->  OK n1:d1 .. nk:dk  (k nearest)               //
+//           S          ->  OK requests=.. batches=.. errors=..          //
+//                              avg_us=.. max_us=..                      //
+//        anything else ->  ERR reason                                   //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- findShortestPath has been run on the graph, and the graph is    //
+//       not changed while the server is running                         //
+//    -- N, K and A search the graph on the worker's thread, with a      //
+//       workspace of that thread, so the graph is only read             //
+//    -- A asks for at most MAXPATHS paths, and answers ERR if its       //
+//       search runs longer than PATHTIMEOUT milliseconds                //
+//    -- every line that arrives in one read is answered as one batch,   //
+//       big batches are split across the worker pool                    //
+//    -- on a socket, one thread polls every client, at most MAXCLIENTS  //
+//       at once, and hands each batch to the worker pool.  A client     //
+//       has one batch at a time being answered                          //
+//    -- a socket client that sends a line longer than MAXLINE gets      //
+//       ERR line too long, after the lines before it, and is dropped    //
+//    -- latency of a request is counted from when its batch was read    //
+//       to when its reply was ready                                     //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#include "queryserver.h"
+#include <sstream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <string.h>
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+
+// one batch from a socket client, answered by the workers
+struct QueryServer::SocketBatch {
+   int client;                        // socket to send the replies to
+   vector<string> batch;              // the request lines
+   vector<string> replies;            // one reply for each request
+   atomic<int> slicesLeft;            // slices not answered yet
+   chrono::steady_clock::time_point start;  // when the batch was read
+};
+
+//--------------------------- Constructor ---------------------------------
+// Constructor for class QueryServer, serves the given graph with the given
+// number of worker threads (0 or less for one per hardware thread)
+// Preconditions:   findShortestPath has been run on the graph
+// Postconditions:  workers are started, all counters are 0
+QueryServer::QueryServer(const GraphM& g, int workers)
+   : graph(g), pool(workers), stopping(false), requests(0), batches(0),
+     errors(0), totalMicros(0), maxMicros(0) {
+   wakeup[0] = wakeup[1] = -1;
+}
+
+//------------------------------- answer ----------------------------------
+// Returns the reply line, without a newline, for one request line
+// Preconditions:   none
+// Postconditions:  the request is counted, but not its latency
+string QueryServer::answer(const string& request) {
+   requests++;
+
+   istringstream in(request);
+   string command;
+   in >> command;
+
+   if (command == "S") {
+      ostringstream reply;
+      reply << "OK ";
+      displayStats(reply);
+      return reply.str();
+   }
+
+   int fromNode, toNode;
+   bool nearby = (command == "N" || command == "K");
+   if (   (   command != "P" && command != "D" && command != "R"
+           && command != "A" && !nearby)
+       || !(in >> fromNode >> toNode)
+       || (nearby && toNode < 0)
+      ) {
+      errors++;
+      return "ERR bad request";
+   }
+
+   //if the nodes inputted are not in the graph, N and K only have one
+   int size = graph.getSize();
+   if (   fromNode > size || fromNode < 1
+       || (!nearby && (toNode > size || toNode < 1))
+      ) {
+      errors++;
+      return "ERR bad node";
+   }
+
+   ostringstream reply;
+   if (command == "A") {               //k shortest paths, k after the nodes
+      int k;
+      vector<vector<int> > paths;
+      vector<int> dists;
+      if (!(in >> k) || k < 1) {
+         errors++;
+         return "ERR bad request";
+      }
+      if (k > MAXPATHS) {
+         errors++;
+         return "ERR k too big";
+      }
+
+      //a search past its deadline is not answered with part of the paths
+      QueryControl control;
+      control.setTimeout(PATHTIMEOUT);
+      int found = graph.findKShortestPaths(fromNode, toNode, k, paths, dists,
+                                           QueryWorkspace::local(), control);
+      if (control.getStatus() != QUERY_DONE) {
+         errors++;
+         return "ERR timed out";
+      }
+      if (found == 0)
+         return "NONE";
+      reply << "OK";
+      for (size_t p = 0; p < paths.size(); p++) {
+         reply << (p == 0 ? " " : "; ") << dists[p];
+         for (size_t i = 0; i < paths[p].size(); i++)
+            reply << " " << paths[p][i];
+      }
+      return reply.str();
+   }
+   if (nearby) {                       //toNode is the radius or k
+      vector<int> nodes, dists;
+      int count = (command == "N")
+                ? graph.findWithinRadius(fromNode, toNode, nodes, dists)
+                : graph.findNearest(fromNode, toNode, nodes, dists);
+      reply << "OK";
+      for (int i = 0; i < count; i++)
+         reply << " " << nodes[i] << ":" << dists[i];
+      return reply.str();
+   }
+   if (command == "R") {
+      reply << "OK " << (graph.isReachable(fromNode, toNode) ? 1 : 0);
+      return reply.str();
+   }
+
+   int dist = graph.getDistance(fromNode, toNode);
+   if (dist == INT_MAX) {              //no path
+      reply << "NONE";
+   } else {
+      reply << "OK " << dist;
+      if (command == "P") {
+         vector<int> nodes;
+         int count = graph.getPath(fromNode, toNode, nodes);
+         for (int i = 0; i < count; i++)
+            reply << " " << nodes[i];
+      }
+   }
+   return reply.str();
+}
+
+//----------------------------- answerBatch -------------------------------
+// Fills replies with one reply for each request, in order. Big batches
+// are split across the workers
+// Preconditions:   none
+// Postconditions:  replies.size() == requests.size()
+void QueryServer::answerBatch(const vector<string>& batch,
+                              vector<string>& replies) {
+   chrono::steady_clock::time_point start = chrono::steady_clock::now();
+   int count = (int)batch.size();
+   replies.assign(count, string());
+   batches++;
+
+   //small batches are cheaper to answer than to hand off
+   if (count <= SLICE) {
+      answerRange(batch, replies, 0, count, start);
+      return;
+   }
+
+   //hand out slices, then wait for every slice to finish
+   mutex doneLock;
+   condition_variable doneSignal;
+   int slicesLeft = (count + SLICE - 1) / SLICE;
+
+   for (int first = 0; first < count; first += SLICE) {
+      int last = first + SLICE < count ? first + SLICE : count;
+      pool.submit([&, first, last]() {
+         answerRange(batch, replies, first, last, start);
+         lock_guard<mutex> guard(doneLock);
+         if (--slicesLeft == 0)
+            doneSignal.notify_one();
+      });
+   }
+
+   unique_lock<mutex> guard(doneLock);
+   while (slicesLeft > 0)
+      doneSignal.wait(guard);
+}
+
+//----------------------------- serveStream -------------------------------
+// Answers requests read from the istream until end of file or stop is
+// called, replies are written to the ostream. stop is seen between
+// batches. When reading cin, stdin is polled, so a stop is also seen
+// while waiting for the next line
+// Preconditions:   none
+// Postconditions:  none
+void QueryServer::serveStream(istream& in, ostream& out) {
+   vector<string> batch, replies;
+   string line;
+
+   while (!stopping) {
+      //wait for stdin a while at a time, so stop is seen. a signal does
+      //not end getline itself, the read is restarted
+      if (&in == &cin && in.rdbuf()->in_avail() <= 0) {
+         pollfd waiting = { 0, POLLIN, 0 };
+         if (poll(&waiting, 1, 250) <= 0)  //nothing yet, or a signal
+            continue;
+      }
+      if (!getline(in, line)) break;
+
+      //take every line that is already buffered as the same batch
+      batch.clear();
+      batch.push_back(line);
+      while (in.rdbuf()->in_avail() > 0 && getline(in, line))
+         batch.push_back(line);
+
+      answerBatch(batch, replies);
+      for (size_t i = 0; i < replies.size(); i++)
+         out << replies[i] << '\n';
+      out.flush();
+   }
+}
+
+//----------------------------- serveSocket -------------------------------
+// Listens on a Unix domain socket at the given path and answers every
+// client that connects, until stop is called. Returns false if the socket
+// could not be opened
+// Preconditions:   none
+// Postconditions:  the socket file is removed
+bool QueryServer::serveSocket(const string& socketPath) {
+   sockaddr_un address;
+   memset(&address, 0, sizeof(address));
+   address.sun_family = AF_UNIX;
+   if (socketPath.length() >= sizeof(address.sun_path))
+      return false;
+   strcpy(address.sun_path, socketPath.c_str());
+
+   int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+   if (listener < 0) return false;
+
+   unlink(socketPath.c_str());        //left over from an old server
+   if (   bind(listener, (sockaddr*)&address, sizeof(address)) != 0
+       || listen(listener, SOMAXCONN) != 0) {
+      close(listener);
+      return false;
+   }
+
+   //woken by the workers when a batch is done, never blocks them
+   if (pipe(wakeup) != 0) {
+      close(listener);
+      unlink(socketPath.c_str());
+      return false;
+   }
+   fcntl(wakeup[0], F_SETFL, O_NONBLOCK);
+   fcntl(wakeup[1], F_SETFL, O_NONBLOCK);
+
+   //one thread reads every client, answering is done by the workers
+   struct Client {
+      int fd;                         // the connected socket, -1 if closed
+      string pending;                 // part of a line not yet ended
+      bool busy;                      // a batch is being answered
+      bool tooLong;                   // sent a line over MAXLINE, drop it
+   };
+   vector<Client> clients;
+   vector<char> buffer(READSIZE);
+   vector<pollfd> waiting;
+   int busyCount = 0;
+
+   //after stop, wait for the batches being answered before closing
+   while (!stopping || busyCount > 0) {
+      waiting.clear();
+      pollfd woken = { wakeup[0], POLLIN, 0 };
+      waiting.push_back(woken);
+      bool listening = !stopping && (int)clients.size() < MAXCLIENTS;
+      pollfd accepting = { listening ? listener : -1, POLLIN, 0 };
+      waiting.push_back(accepting);
+      for (size_t i = 0; i < clients.size(); i++) {
+         //a busy client is not read, so its batches stay in order
+         bool reading = !clients[i].busy && !clients[i].tooLong && !stopping;
+         pollfd client = { reading ? clients[i].fd : -1, POLLIN, 0 };
+         waiting.push_back(client);
+      }
+      if (poll(&waiting[0], waiting.size(), 250) <= 0)  //check stopping
+         continue;
+
+      //every whole line in one read is one batch
+      for (size_t i = 0; i < clients.size(); i++) {
+         if (waiting[i + 2].revents == 0) continue;
+         ssize_t got = read(clients[i].fd, &buffer[0], buffer.size());
+         if (got < 0 && errno == EINTR) continue;
+         if (got <= 0) {               //client hung up
+            close(clients[i].fd);
+            clients[i].fd = -1;
+            continue;
+         }
+
+         shared_ptr<SocketBatch> job(new SocketBatch);
+         string& pending = clients[i].pending;
+         pending.append(&buffer[0], got);
+         size_t begin = 0, end;
+         while ((end = pending.find('\n', begin)) != string::npos) {
+            job->batch.push_back(pending.substr(begin, end - begin));
+            begin = end + 1;
+         }
+         pending.erase(0, begin);
+
+         //a line that never ends would hold more and more memory, so the
+         //client is dropped once the lines before it are answered
+         if (pending.size() > (size_t)MAXLINE) {
+            clients[i].tooLong = true;
+            pending.clear();
+            if (job->batch.empty()) {
+               refuseLine(clients[i].fd);
+               clients[i].fd = -1;
+            }
+         }
+         if (job->batch.empty()) continue;
+
+         job->client = clients[i].fd;
+         job->start = chrono::steady_clock::now();
+         clients[i].busy = true;
+         busyCount++;
+         startBatch(job);
+      }
+
+      //clients whose batch is done can be read again, or have gone away
+      if (waiting[0].revents != 0) {
+         char drain[256];
+         while (read(wakeup[0], drain, sizeof(drain)) > 0)
+            ;
+         vector<pair<int, bool> > done;
+         {
+            lock_guard<mutex> guard(finishedLock);
+            done.swap(finished);
+         }
+         for (size_t d = 0; d < done.size(); d++) {
+            for (size_t i = 0; i < clients.size(); i++) {
+               if (clients[i].fd != done[d].first || !clients[i].busy)
+                  continue;
+               clients[i].busy = false;
+               busyCount--;
+               if (!done[d].second) {   //reply could not be sent
+                  close(clients[i].fd);
+                  clients[i].fd = -1;
+               } else if (clients[i].tooLong) {
+                  refuseLine(clients[i].fd);
+                  clients[i].fd = -1;
+               }
+               break;
+            }
+         }
+      }
+
+      //forget closed clients, only ever closed when not busy
+      size_t kept = 0;
+      for (size_t i = 0; i < clients.size(); i++)
+         if (clients[i].fd >= 0)
+            clients[kept++] = clients[i];
+      clients.resize(kept);
+
+      if (waiting[1].revents != 0) {
+         int client = accept(listener, NULL, NULL);
+         if (client >= 0) {
+            //a client that stops reading can not hold a worker for long
+            timeval timeout = { SENDTIMEOUT, 0 };
+            setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout,
+                       sizeof(timeout));
+            Client added = { client, string(), false, false };
+            clients.push_back(added);
+         }
+      }
+   }
+
+   for (size_t i = 0; i < clients.size(); i++)
+      close(clients[i].fd);
+   close(wakeup[0]);
+   close(wakeup[1]);
+   close(listener);
+   unlink(socketPath.c_str());
+   return true;
+}
+
+//-------------------------------- stop -----------------------------------
+// Asks serveSocket and serveStream to return. Safe to call from a signal
+// handler
+// Preconditions:   none
+// Postconditions:  none
+void QueryServer::stop() {
+   stopping = true;
+}
+
+//---------------------------- displayStats -------------------------------
+// Displays request, batch and latency counters to the ostream
+// Preconditions:   none
+// Postconditions:  none
+void QueryServer::displayStats(ostream& out) const {
+   long long count = requests;
+   out << "requests=" << count << " batches=" << batches
+       << " errors=" << errors
+       << " avg_us=" << (count > 0 ? totalMicros / count : 0)
+       << " max_us=" << maxMicros;
+}
+
+//---------------------------- answerRange --------------------------------
+// Helper for answerBatch. Answers requests [first, last) and records the
+// latency of each one since the batch started
+// Preconditions:   replies is already sized for the whole batch
+// Postconditions:  replies[first, last) are filled
+void QueryServer::answerRange(const vector<string>& batch,
+                              vector<string>& replies, int first, int last,
+                              chrono::steady_clock::time_point start) {
+   for (int i = first; i < last; i++) {
+      replies[i] = answer(batch[i]);
+      recordLatency(chrono::duration_cast<chrono::microseconds>(
+                       chrono::steady_clock::now() - start).count());
+   }
+}
+
+//----------------------------- startBatch --------------------------------
+// Helper for serveSocket. Hands the batch to the workers in slices and
+// returns without waiting. The last slice to finish calls finishBatch
+// Preconditions:   the batch is not empty
+// Postconditions:  none
+void QueryServer::startBatch(const shared_ptr<SocketBatch>& job) {
+   int count = (int)job->batch.size();
+   job->replies.assign(count, string());
+   job->slicesLeft = (count + SLICE - 1) / SLICE;
+   batches++;
+
+   //the slices share the batch, the last one to finish sends the replies
+   for (int first = 0; first < count; first += SLICE) {
+      int last = first + SLICE < count ? first + SLICE : count;
+      pool.submit([this, job, first, last]() {
+         answerRange(job->batch, job->replies, first, last, job->start);
+         if (--job->slicesLeft == 0)
+            finishBatch(*job);
+      });
+   }
+}
+
+//---------------------------- finishBatch --------------------------------
+// Helper for startBatch. Sends the replies of the batch to its client,
+// then adds the client to finished and wakes serveSocket
+// Preconditions:   every reply of the batch is filled
+// Postconditions:  none
+void QueryServer::finishBatch(SocketBatch& job) {
+   string out;
+   for (size_t i = 0; i < job.replies.size(); i++) {
+      out += job.replies[i];
+      out += '\n';
+   }
+
+   //send all of it, the socket may take it in pieces
+   size_t sent = 0;
+   while (sent < out.length()) {
+      ssize_t n = send(job.client, out.data() + sent, out.length() - sent,
+                       MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR) continue;
+      if (n <= 0) break;               //client went away, or timed out
+      sent += n;
+   }
+
+   {
+      lock_guard<mutex> guard(finishedLock);
+      finished.push_back(make_pair(job.client, sent == out.length()));
+   }
+   char wake = 1;
+   if (write(wakeup[1], &wake, 1) < 0) {
+      //pipe full, serveSocket is already due to wake up
+   }
+}
+
+//---------------------------- recordLatency ------------------------------
+// Adds one request's latency, in microseconds, to the counters
+// Preconditions:   none
+// Postconditions:  none
+void QueryServer::recordLatency(long long micros) {
+   totalMicros += micros;
+   long long slowest = maxMicros;
+   while (micros > slowest && !maxMicros.compare_exchange_weak(slowest, micros))
+      ;
+}
+
+//----------------------------- refuseLine --------------------------------
+// Helper for serveSocket. Tells a client its line is too long, without
+// waiting if the client is not reading, and closes its socket
+// Preconditions:   the socket is open and no batch of it is being answered
+// Postconditions:  the socket is closed, the error is counted
+void QueryServer::refuseLine(int client) {
+   errors++;
+   const char reply[] = "ERR line too long\n";
+   send(client, reply, sizeof(reply) - 1, MSG_DONTWAIT | MSG_NOSIGNAL);
+   close(client);
+}
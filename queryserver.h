@@ -0,0 +1,173 @@
+//-----------------------------------------------------------------------//
+// QUERYSERVER.H                                                         //
+//                                                                       //
+// QueryServer answers shortest path questions about one GraphM that is  //
+// loaded once, over a stream (stdin) or a Unix domain socket            //
+//-----------------------------------------------------------------------//
+// Protocol: one request per line, one reply line per request, replies   //
+//        in the same order as the requests.  Node numbers as in GraphM. //
+//           P from to  ->  OK dist n1 n2 .. nk   (path)  or  NONE       //
+//           D from to  ->  OK dist                       or  NONE       //
+//           R from to  ->  OK 1  (reachable)  or  OK 0                  //
+//           A from to k -> OK dist n1 .. nk; dist ..  or  NONE          //
+//                          (k shortest loopless paths, shortest first)  //
+//           N from r   ->  OK n1:d1 .. nk:dk  (within distance r)       //
+//           K from k   ->  OK n1:d1 .. nk:dk  (k nearest)               //
+//           S          ->  OK requests=.. batches=.. errors=..          //
+//                              avg_us=.. max_us=..                      //
+//        anything else ->  ERR reason                                   //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- findShortestPath has been run on the graph, and the graph is    //
+//       not changed while the server is running                         //
+//    -- N, K and A search the graph on the worker's thread, with a      //
+//       workspace of that thread, so the graph is only read             //
+//    -- A asks for at most MAXPATHS paths, and answers ERR if its       //
+//       search runs longer than PATHTIMEOUT milliseconds                //
+//    -- every line that arrives in one read is answered as one batch,   //
+//       big batches are split across the worker pool                    //
+//    -- on a socket, one thread polls every client, at most MAXCLIENTS  //
+//       at once, and hands each batch to the worker pool.  A client     //
+//       has one batch at a time being answered                          //
+//    -- a socket client that sends a line longer than MAXLINE gets      //
+//       ERR line too long, after the lines before it, and is dropped    //
+//    -- latency of a request is counted from when its batch was read    //
+//       to when its reply was ready                                     //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#ifndef QUERYSERVER_H
+#define QUERYSERVER_H
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <memory>
+#include <utility>
+#include "graphm.h"
+#include "workerpool.h"
+using namespace std;
+
+class QueryServer {
+
+public:
+//--------------------------- Constructor ---------------------------------
+// Constructor for class QueryServer, serves the given graph with the given
+// number of worker threads (0 or less for one per hardware thread)
+// Preconditions:   findShortestPath has been run on the graph
+// Postconditions:  workers are started, all counters are 0
+QueryServer(const GraphM&, int);
+
+//------------------------------- answer ----------------------------------
+// Returns the reply line, without a newline, for one request line
+// Preconditions:   none
+// Postconditions:  the request is counted, but not its latency
+string answer(const string&);
+
+//----------------------------- answerBatch -------------------------------
+// Fills replies with one reply for each request, in order. Big batches
+// are split across the workers
+// Preconditions:   none
+// Postconditions:  replies.size() == requests.size()
+void answerBatch(const vector<string>&, vector<string>&);
+
+//----------------------------- serveStream -------------------------------
+// Answers requests read from the istream until end of file or stop is
+// called, replies are written to the ostream. stop is seen between
+// batches. When reading cin, stdin is polled, so a stop is also seen
+// while waiting for the next line
+// Preconditions:   none
+// Postconditions:  none
+void serveStream(istream&, ostream&);
+
+//----------------------------- serveSocket -------------------------------
+// Listens on a Unix domain socket at the given path and answers every
+// client that connects, until stop is called. Returns false if the socket
+// could not be opened
+// Preconditions:   none
+// Postconditions:  the socket file is removed
+bool serveSocket(const string&);
+
+//-------------------------------- stop -----------------------------------
+// Asks serveSocket and serveStream to return. Safe to call from a signal
+// handler
+// Preconditions:   none
+// Postconditions:  none
+void stop();
+
+//---------------------------- displayStats -------------------------------
+// Displays request, batch and latency counters to the ostream
+// Preconditions:   none
+// Postconditions:  none
+void displayStats(ostream&) const;
+
+private:
+
+   static const int SLICE = 64;     // requests per worker task in a batch
+   static const int READSIZE = 65536;  // bytes read from a socket at once
+   static const int MAXCLIENTS = 256;  // most socket clients at once
+   static const int SENDTIMEOUT = 5;   // seconds a reply may wait to send
+   static const int MAXLINE = 4096;    // longest request line from a client
+   static const int MAXPATHS = 100;    // most paths an A request may ask for
+   static const int PATHTIMEOUT = 1000;  // milliseconds an A request may run
+
+   struct SocketBatch;              // a client's batch being answered
+
+   const GraphM& graph;             // the graph being served
+   WorkerPool pool;                 // threads that answer big batches
+   atomic<bool> stopping;           // set by stop
+
+   atomic<long long> requests;      // requests answered
+   atomic<long long> batches;       // batches answered
+   atomic<long long> errors;        // requests answered with ERR
+   atomic<long long> totalMicros;   // latency of all requests added up
+   atomic<long long> maxMicros;     // slowest request
+
+   mutex finishedLock;              // guards finished
+   vector<pair<int, bool> > finished;  // (client, reply was sent) of each
+                                    // batch done, for serveSocket
+   int wakeup[2];                   // pipe, written when a batch is done
+
+   QueryServer(const QueryServer&);             // not copyable
+   QueryServer& operator=(const QueryServer&);
+
+//---------------------------- answerRange --------------------------------
+// Helper for answerBatch. Answers requests [first, last) and records the
+// latency of each one since the batch started
+// Preconditions:   replies is already sized for the whole batch
+// Postconditions:  replies[first, last) are filled
+void answerRange(const vector<string>&, vector<string>&, int, int,
+                 chrono::steady_clock::time_point);
+
+//----------------------------- startBatch --------------------------------
+// Helper for serveSocket. Hands the batch to the workers in slices and
+// returns without waiting. The last slice to finish calls finishBatch
+// Preconditions:   the batch is not empty
+// Postconditions:  none
+void startBatch(const shared_ptr<SocketBatch>&);
+
+//---------------------------- finishBatch --------------------------------
+// Helper for startBatch. Sends the replies of the batch to its client,
+// then adds the client to finished and wakes serveSocket
+// Preconditions:   every reply of the batch is filled
+// Postconditions:  none
+void finishBatch(SocketBatch&);
+
+//---------------------------- recordLatency ------------------------------
+// Adds one request's latency, in microseconds, to the counters
+// Preconditions:   none
+// Postconditions:  none
+void recordLatency(long long);
+
+//----------------------------- refuseLine --------------------------------
+// Helper for serveSocket. Tells a client its line is too long, without
+// waiting if the client is not reading, and closes its socket
+// Preconditions:   the socket is open and no batch of it is being answered
+// Postconditions:  the socket is closed, the error is counted
+void refuseLine(int);
+
+};
+
+#endif
@@ -0,0 +1,70 @@
+//-----------------------------------------------------------------------//
+// QUERYWORKSPACE.CPP                                                    //
+//                                                                       //
+// QueryWorkspace holds the scratch data of one graph search (visited    //
+// marks, distances, paths, heap) so the graph itself is never changed   //
+// by a search, and many threads can search the same graph at once       //
+//-----------------------------------------------------------------------//
+// Epoch: every search starts with begin, which bumps epoch.  A node's   //
+//        entry only counts if its stamp equals epoch, so nothing has    //
+//        to be cleared between searches.                                //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- data members are public for simplicity, like the structs in     //
+//       GraphL. Searches read and write them directly                   //
+//    -- one workspace is used by one search at a time.  local returns   //
+//       a workspace that belongs to the calling thread                  //
+//    -- arrays start storing data at index 1, so that node numbers are  //
+//       equal to index number                                           //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#include "queryworkspace.h"
+
+//--------------------------- Constructor ---------------------------------
+// Default constructor for class QueryWorkspace
+// Preconditions:   none
+// Postconditions:  all arrays are empty and epoch is 0
+QueryWorkspace::QueryWorkspace() {
+   epoch = 0;
+}
+
+//------------------------------- begin -----------------------------------
+// Starts a new search of a graph with the given number of nodes. Grows
+// the arrays if needed and bumps epoch, only clearing the stamps when
+// epoch wraps around. The heap and list are emptied
+// Preconditions:   none
+// Postconditions:  no node is stamped for the new epoch
+void QueryWorkspace::begin(int size) {
+   size_t needed = size > 0 ? (size_t)size + 1 : 1;
+   if (seen.size() < needed) {      //new entries are stamped 0, unseen
+      seen.resize(needed, 0);
+      done.resize(needed, 0);
+      blocked.resize(needed, 0);
+      cut.resize(needed, 0);
+      dist.resize(needed, 0);
+      path.resize(needed, 0);
+   }
+
+   epoch++;
+   if (epoch == 0) {                //wrapped, old stamps could match
+      seen.assign(seen.size(), 0);
+      done.assign(done.size(), 0);
+      blocked.assign(blocked.size(), 0);
+      cut.assign(cut.size(), 0);
+      epoch = 1;
+   }
+
+   heap.clear();
+   list.clear();
+}
+
+//------------------------------- local -----------------------------------
+// Returns the workspace of the calling thread, made the first time the
+// thread asks for it
+// Preconditions:   none
+// Postconditions:  none
+QueryWorkspace& QueryWorkspace::local() {
+   static thread_local QueryWorkspace workspace;
+   return workspace;
+}
@@ -0,0 +1,71 @@
+//-----------------------------------------------------------------------//
+// QUERYWORKSPACE.H                                                      //
+//                                                                       //
+// QueryWorkspace holds the scratch data of one graph search (visited    //
+// marks, distances, paths, heap) so the graph itself is never changed   //
+// by a search, and many threads can search the same graph at once       //
+//-----------------------------------------------------------------------//
+// Epoch: every search starts with begin, which bumps epoch.  A node's   //
+//        entry only counts if its stamp equals epoch, so nothing has    //
+//        to be cleared between searches.                                //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- data members are public for simplicity, like the structs in     //
+//       GraphL. Searches read and write them directly                   //
+//    -- one workspace is used by one search at a time.  local returns   //
+//       a workspace that belongs to the calling thread                  //
+//    -- arrays start storing data at index 1, so that node numbers are  //
+//       equal to index number                                           //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#ifndef QUERYWORKSPACE_H
+#define QUERYWORKSPACE_H
+#include <vector>
+#include <utility>
+using namespace std;
+
+class QueryWorkspace {
+
+public:
+//--------------------------- Constructor ---------------------------------
+// Default constructor for class QueryWorkspace
+// Preconditions:   none
+// Postconditions:  all arrays are empty and epoch is 0
+QueryWorkspace();
+
+//------------------------------- begin -----------------------------------
+// Starts a new search of a graph with the given number of nodes. Grows
+// the arrays if needed and bumps epoch, only clearing the stamps when
+// epoch wraps around. The heap and list are emptied
+// Preconditions:   none
+// Postconditions:  no node is stamped for the new epoch
+void begin(int);
+
+//------------------------------- local -----------------------------------
+// Returns the workspace of the calling thread, made the first time the
+// thread asks for it
+// Preconditions:   none
+// Postconditions:  none
+static QueryWorkspace& local();
+
+   unsigned int epoch;          // stamp of the current search
+   vector<unsigned int> seen;   // epoch when dist and path were set
+   vector<unsigned int> done;   // epoch when the node was settled/visited
+   vector<unsigned int> blocked;  // epoch when the node was taken out
+   vector<unsigned int> cut;    // epoch when the edge to the node from
+                                // the search's start was taken out
+   vector<int> dist;            // best distance found, if seen
+   vector<int> path;            // previous node on that path, if seen
+   vector<pair<int, int> > heap;  // (dist, node) min heap storage
+   vector<int> list;            // stack, queue or order storage
+   vector<unsigned long long> bits;  // visited bits, sized by the search
+
+private:
+
+   QueryWorkspace(const QueryWorkspace&);             // not copyable
+   QueryWorkspace& operator=(const QueryWorkspace&);
+
+};
+
+#endif
@@ -0,0 +1,97 @@
+//-----------------------------------------------------------------------//
+// WORKERPOOL.CPP                                                        //
+//                                                                       //
+// WorkerPool runs submitted tasks on a fixed set of threads             //
+//-----------------------------------------------------------------------//
+// Task: any function taking and returning nothing.  Tasks are started   //
+//        in the order they were submitted, on whichever thread is free. //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- tasks do not throw                                              //
+//    -- tasks never wait on other tasks of the same pool, or the pool   //
+//       can run out of free threads                                     //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#include "workerpool.h"
+
+//--------------------------- Constructor ---------------------------------
+// Constructor for class WorkerPool, starts the given number of threads.
+// 0 or less starts one thread per hardware thread
+// Preconditions:   none
+// Postconditions:  threads are waiting for tasks
+WorkerPool::WorkerPool(int count) {
+   stopping = false;
+   if (count <= 0)
+      count = (int)thread::hardware_concurrency();
+   if (count <= 0)                     //hardware count is not known
+      count = 1;
+
+   for (int i = 0; i < count; i++)
+      threads.push_back(thread(&WorkerPool::workerLoop, this));
+}
+
+//---------------------------- Destructor ---------------------------------
+// Destructor for class WorkerPool
+// Preconditions:   none
+// Postconditions:  tasks already submitted are finished, threads are
+//          joined
+WorkerPool::~WorkerPool() {
+   shutdown();
+}
+
+//------------------------------- submit ----------------------------------
+// Queues a task to be run by one of the threads
+// Preconditions:   shutdown has not been called
+// Postconditions:  the task runs some time later
+void WorkerPool::submit(const function<void()>& task) {
+   {
+      lock_guard<mutex> guard(lock);
+      tasks.push_back(task);
+   }
+   ready.notify_one();
+}
+
+//------------------------------ shutdown ---------------------------------
+// Finishes every queued task and joins the threads. Safe to call twice
+// Preconditions:   none
+// Postconditions:  no threads are running
+void WorkerPool::shutdown() {
+   {
+      lock_guard<mutex> guard(lock);
+      stopping = true;
+   }
+   ready.notify_all();
+
+   for (size_t i = 0; i < threads.size(); i++)
+      if (threads[i].joinable())
+         threads[i].join();
+}
+
+//----------------------------- threadCount -------------------------------
+// Returns the number of threads in the pool
+// Preconditions:   none
+// Postconditions:  none
+int WorkerPool::threadCount() const {
+   return (int)threads.size();
+}
+
+//------------------------------ workerLoop -------------------------------
+// Body of each thread. Runs tasks until shutdown and the queue is empty
+// Preconditions:   none
+// Postconditions:  none
+void WorkerPool::workerLoop() {
+   for (;;) {
+      function<void()> task;
+      {
+         unique_lock<mutex> guard(lock);
+         while (!stopping && tasks.empty())
+            ready.wait(guard);
+         if (tasks.empty())            //stopping and nothing left to do
+            return;
+         task = tasks.front();
+         tasks.pop_front();
+      }
+      task();
+   }
+}
@@ -0,0 +1,80 @@
+//-----------------------------------------------------------------------//
+// WORKERPOOL.H                                                          //
+//                                                                       //
+// WorkerPool runs submitted tasks on a fixed set of threads             //
+//-----------------------------------------------------------------------//
+// Task: any function taking and returning nothing.  Tasks are started   //
+//        in the order they were submitted, on whichever thread is free. //
+//                                                                       //
+// Implementation and assumptions:                                       //
+//    -- tasks do not throw                                              //
+//    -- tasks never wait on other tasks of the same pool, or the pool   //
+//       can run out of free threads                                     //
+//                                                                       //
+//-----------------------------------------------------------------------//
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+using namespace std;
+
+class WorkerPool {
+
+public:
+//--------------------------- Constructor ---------------------------------
+// Constructor for class WorkerPool, starts the given number of threads.
+// 0 or less starts one thread per hardware thread
+// Preconditions:   none
+// Postconditions:  threads are waiting for tasks
+WorkerPool(int);
+
+//---------------------------- Destructor ---------------------------------
+// Destructor for class WorkerPool
+// Preconditions:   none
+// Postconditions:  tasks already submitted are finished, threads are
+//          joined
+~WorkerPool();
+
+//------------------------------- submit ----------------------------------
+// Queues a task to be run by one of the threads
+// Preconditions:   shutdown has not been called
+// Postconditions:  the task runs some time later
+void submit(const function<void()>&);
+
+//------------------------------ shutdown ---------------------------------
+// Finishes every queued task and joins the threads. Safe to call twice
+// Preconditions:   none
+// Postconditions:  no threads are running
+void shutdown();
+
+//----------------------------- threadCount -------------------------------
+// Returns the number of threads in the pool
+// Preconditions:   none
+// Postconditions:  none
+int threadCount() const;
+
+private:
+
+   vector<thread> threads;          // the workers
+   deque<function<void()> > tasks;  // tasks waiting for a worker
+   mutex lock;                      // guards tasks and stopping
+   condition_variable ready;        // signalled when a task is queued
+   bool stopping;                   // true once shutdown is called
+
+   WorkerPool(const WorkerPool&);             // not copyable
+   WorkerPool& operator=(const WorkerPool&);
+
+//------------------------------ workerLoop -------------------------------
+// Body of each thread. Runs tasks until shutdown and the queue is empty
+// Preconditions:   none
+// Postconditions:  none
+void workerLoop();
+
+};
+
+#endif